@@ -0,0 +1,77 @@
+#include "Animation.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+float lerp(float startValue, float endValue, float t) {
+	return startValue * (1.0f - t) + endValue * t;
+}
+
+glm::vec3 lerp(glm::vec3 start, glm::vec3 end, float t) {
+	return glm::vec3(lerp(start.x, end.x, t), lerp(start.y, end.y, t), lerp(start.z, end.z, t));
+}
+
+Animation::Animation(std::vector<Frame> fv) {
+	frames = fv;
+	lastFrame = 0;
+	currentFrame = 1;
+	frameSwitchTime = 0;
+	startTime = 0;
+	animating = true;
+}
+
+void Animation::AddFrame(Frame frame) {
+	frames.push_back(frame);
+}
+
+bool Animation::Update(unsigned long long time, glm::mat4 &outTransform) {
+	if (!animating) return false;
+	if (frames.size() < 2) return false; // frame[0] == initial position, frame[1..n] == transitions
+
+	// Get frames
+	Frame last = frames[lastFrame];
+	Frame current = frames[currentFrame];
+
+	unsigned long long delta = time - frameSwitchTime;
+	while (delta > current.duration) {
+		// Get next frame
+		if (currentFrame + 1 > frames.size() - 1) {
+			animating = false;
+			return false;
+		}
+
+		// The new frame started when the old one ended, not at this update
+		frameSwitchTime += current.duration;
+		delta -= current.duration;
+
+		// Set new frames
+		last = frames[++lastFrame];
+		current = frames[++currentFrame];
+	}
+
+	float p = current.duration > 0 ? glm::min((float)delta / (float)current.duration, 1.0f) : 1.0f;
+
+	// Apply transformation
+	outTransform = glm::translate(outTransform, lerp(last.position, current.position, p));
+
+	return true;
+}
+
+bool Animation::IsAnimating() {
+	return animating;
+}
+
+unsigned long long Animation::GetEndTime() {
+	unsigned long long endTime = startTime;
+	for (size_t i = 1; i < frames.size(); i++) {
+		endTime += frames[i].duration;
+	}
+	return endTime;
+}
+
+void Animation::Reset(unsigned long long time) {
+	animating = true;
+	lastFrame = 0;
+	currentFrame = 1;
+	frameSwitchTime = time;
+	startTime = time;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+float lerp(float startValue, float endValue, float t);
+glm::vec3 lerp(glm::vec3 start, glm::vec3 end, float t);
+
+struct Frame {
+	glm::vec3 position;
+	unsigned int duration;
+
+	Frame(glm::vec3 p, unsigned int d) {
+		position = p;
+		duration = d;
+	}
+};
+
+// Key-frame translation: frames[0] is the initial position, and each following
+// frame is reached after its duration (in milliseconds). Time only has to increase;
+// a large jump carries over into the following frames rather than skipping them.
+class Animation {
+	std::vector<Frame> frames;
+	unsigned int lastFrame;
+	unsigned int currentFrame;
+	unsigned long long frameSwitchTime;
+	unsigned long long startTime;
+	bool animating;
+
+public:
+	Animation(std::vector<Frame> fv);
+
+	void AddFrame(Frame frame);
+
+	bool Update(unsigned long long time, glm::mat4 &outTransform);
+
+	bool IsAnimating();
+
+	// When the last frame is reached, counting from the last Reset
+	unsigned long long GetEndTime();
+
+	void Reset(unsigned long long time);
+};
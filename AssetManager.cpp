@@ -0,0 +1,111 @@
+#include "AssetManager.h"
+#include "MappedFile.h"
+
+#include <iostream>
+
+#include "apis/stb_image.h"
+
+AssetManager::AssetManager(unsigned int numThreads) : numPending(0), workers(numThreads) {
+}
+
+void AssetManager::submit(std::function<void()> work, std::function<void()> done) {
+	this->numPending++;
+
+	this->workers.enqueue([this, work, done]() {
+		work();
+
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->completions.push_back(done);
+		}
+		this->completed.notify_all();
+	});
+}
+
+void AssetManager::loadCubemap(const std::string filename, const glm::vec3 front, const glm::vec3 up, const int mipFilter, const bool compress,
+	std::function<void(CubemapImage&)> done) {
+	std::shared_ptr<CubemapImage> image = std::make_shared<CubemapImage>();
+	image->filename = filename;
+
+	this->submit([image, front, up, mipFilter, compress]() {
+		// compressed faces are cached together as one DDS cube map, so later runs skip
+		// decoding, projecting and compressing
+		std::string cacheFilename = TextureCompressor::getCubemapCacheFilename(image->filename);
+		unsigned int projection = CubemapGenerator::getProjectionHash(front, up);
+		if (compress && TextureCompressor::readDdsCubemap(cacheFilename, image->filename, mipFilter, projection, image->compressedFaces)) {
+			image->hash = image->compressedFaces[0].hash;
+			image->faceSize = image->compressedFaces[0].width;
+			for (CompressedImage &face : image->compressedFaces) {
+				face.filename = image->filename;
+				face.fromCache = true;
+			}
+			return;
+		}
+
+		int width, height, numComponents;
+		image->hash = MappedFile::hashFile(image->filename);
+		unsigned char* pixels = stbi_load(image->filename.c_str(), &width, &height, &numComponents, 4);
+		if (pixels == nullptr) {
+			// kept per thread (see apis/stb_image.h), so other loads cannot overwrite it
+			image->error = stbi_failure_reason();
+			return;
+		}
+
+		image->faceSize = CubemapGenerator::getFaceSize(width);
+		CubemapGenerator::fromEquirectangular(pixels, width, height, front, up, image->faceSize, image->faces);
+		stbi_image_free(pixels);
+
+		image->mips.resize(image->faces.size());
+		for (size_t f = 0; f < image->faces.size(); f++) {
+			MipmapGenerator::generate(image->faces[f].pixels.data(), image->faceSize, image->faceSize, mipFilter, true, image->mips[f]);
+		}
+		if (!compress) {
+			return;
+		}
+
+		image->compressedFaces.resize(image->faces.size());
+		for (size_t f = 0; f < image->faces.size(); f++) {
+			CompressedImage &face = image->compressedFaces[f];
+			face.filename = image->filename;
+			face.hash = image->hash;
+			TextureCompressor::compress(image->faces[f].pixels.data(), image->faceSize, image->faceSize, mipFilter, image->mips[f], face);
+		}
+		image->faces.clear();
+		image->mips.clear();
+
+		if (!TextureCompressor::writeDdsCubemap(cacheFilename, image->filename, projection, image->compressedFaces)) {
+			std::cout << "  could not write cache " << cacheFilename << std::endl;
+		}
+	}, [image, done]() {
+		done(*image);
+	});
+}
+
+unsigned int AssetManager::processCompletions() {
+	std::deque<std::function<void()>> ready;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		ready.swap(this->completions);
+	}
+
+	for (std::function<void()> &done : ready) {
+		done();
+		this->numPending--;
+	}
+
+	return ready.size();
+}
+
+unsigned int AssetManager::getNumPending() {
+	return this->numPending;
+}
+
+void AssetManager::finish() {
+	while (this->numPending > 0) {
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+			this->completed.wait(lock, [this] { return !this->completions.empty(); });
+		}
+		this->processCompletions();
+	}
+}
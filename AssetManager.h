@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "CubemapGenerator.h"
+#include "MipmapGenerator.h"
+#include "TextureCompressor.h"
+#include "ThreadPool.h"
+
+// Reads and decodes assets on worker threads so the render loop is never blocked on
+// the disk. Nothing here touches GL: each load finishes with a callback that runs on
+// whichever thread calls processCompletions, which is where the GL upload belongs.
+class AssetManager {
+private:
+	std::mutex mutex;
+	std::condition_variable completed;
+	std::deque<std::function<void()>> completions;
+	std::atomic<unsigned int> numPending;
+
+	// last, so it is destroyed first: its destructor finishes the queued loads, which
+	// still need the completion queue
+	ThreadPool workers;
+
+	AssetManager(const AssetManager&) = delete;
+	AssetManager& operator=(const AssetManager&) = delete;
+
+public:
+	explicit AssetManager(unsigned int numThreads = 2);
+
+	// Runs work on a worker, then queues done for processCompletions
+	void submit(std::function<void()> work, std::function<void()> done);
+
+	// Decodes a latitude/longitude image and projects it onto a cube map oriented by
+	// front and up (see CubemapGenerator), with a mip chain per face; with compress, the
+	// faces are DXT compressed too, and read from (or written to) a .cube.dds cache next
+	// to the image. done gets an image without faces if it could not be decoded
+	void loadCubemap(const std::string filename, const glm::vec3 front, const glm::vec3 up, const int mipFilter, const bool compress,
+		std::function<void(CubemapImage&)> done);
+
+	// Runs the callbacks of finished loads, in the order they finished, and returns how many ran
+	unsigned int processCompletions();
+
+	// loads submitted whose callbacks have not run yet
+	unsigned int getNumPending();
+
+	// Blocks until every submitted load has finished and run its callback
+	void finish();
+};
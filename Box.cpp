@@ -0,0 +1,18 @@
+#include "Box.h"
+
+Box::Box(float width, float height, float depth) : size(width, height, depth) {
+	glm::vec3 half = this->size * 0.5f;
+	glm::vec3 x(half.x, 0.0f, 0.0f);
+	glm::vec3 y(0.0f, half.y, 0.0f);
+	glm::vec3 z(0.0f, 0.0f, half.z);
+
+	// u x v points out of each face
+	this->addQuad(x, -z, y, glm::vec3(1.0f, 0.0f, 0.0f));
+	this->addQuad(-x, z, y, glm::vec3(-1.0f, 0.0f, 0.0f));
+	this->addQuad(y, x, -z, glm::vec3(0.0f, 1.0f, 0.0f));
+	this->addQuad(-y, x, z, glm::vec3(0.0f, -1.0f, 0.0f));
+	this->addQuad(z, x, y, glm::vec3(0.0f, 0.0f, 1.0f));
+	this->addQuad(-z, -x, y, glm::vec3(0.0f, 0.0f, -1.0f));
+}
+
+glm::vec3 Box::getSize() { return this->size; }
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "ProceduralMesh.h"
+
+// Axis aligned box centred on the origin; each face has its own four vertices so the
+// normals stay flat, and its own 0..1 uvs
+class Box : public ProceduralMesh {
+private:
+	glm::vec3 size;
+
+public:
+	Box(float width, float height, float depth);
+
+	glm::vec3 getSize();
+};
@@ -0,0 +1,46 @@
+#include "Capsule.h"
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+Capsule::Capsule(float radius, float height, unsigned int numSegments, unsigned int numRings)
+	: radius(radius), height(height), numSegments(numSegments), numRings(numRings) {
+	float halfHeight = height * 0.5f;
+
+	// v follows the length of the outline, so the texture is not stretched over the caps
+	float capLength = (float)(M_PI * 0.5) * radius;
+	float totalLength = 2.0f * capLength + height;
+
+	// south pole to the bottom of the cylinder, then north from its top; the side is the
+	// quad strip between the two equators
+	std::vector<LathePoint> outline;
+	for (int hemisphere = 0; hemisphere < 2; hemisphere++) {
+		for (unsigned int j = 0; j <= numRings; j++) {
+			double phi = (M_PI * 0.5) * j / numRings;
+			if (hemisphere == 0) {
+				phi -= M_PI * 0.5;
+			}
+
+			bool pole = (hemisphere == 0 && j == 0) || (hemisphere == 1 && j == numRings);
+			float c = pole ? 0.0f : (float)cos(phi);
+			float s = (float)sin(phi);
+			float centreY = hemisphere == 0 ? -halfHeight : halfHeight;
+			float arc = (float)(phi + M_PI * 0.5) * radius;
+
+			LathePoint point;
+			point.radius = radius * c;
+			point.y = centreY + radius * s;
+			point.normalRadius = c;
+			point.normalY = s;
+			point.v = (hemisphere == 0 ? arc : arc + height) / totalLength;
+			outline.push_back(point);
+		}
+	}
+
+	this->addLathe(outline, numSegments);
+}
+
+float Capsule::getRadius() { return this->radius; }
+float Capsule::getHeight() { return this->height; }
+unsigned int Capsule::getNumSegments() { return this->numSegments; }
+unsigned int Capsule::getNumRings() { return this->numRings; }
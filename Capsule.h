@@ -0,0 +1,21 @@
+#pragma once
+
+#include "ProceduralMesh.h"
+
+// Cylinder of the given height around the y axis with a hemisphere on each end, so it
+// is height + 2 * radius tall. Each hemisphere has numRings steps from pole to equator.
+class Capsule : public ProceduralMesh {
+private:
+	float radius;
+	float height;
+	unsigned int numSegments;
+	unsigned int numRings;
+
+public:
+	Capsule(float radius, float height, unsigned int numSegments, unsigned int numRings);
+
+	float getRadius();
+	float getHeight();
+	unsigned int getNumSegments();
+	unsigned int getNumRings();
+};
@@ -0,0 +1,114 @@
+#include "CubemapGenerator.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <glm/gtc/constants.hpp>
+
+size_t CubemapImage::getSize() const {
+	size_t size = 0;
+	for (const CompressedImage &face : this->compressedFaces) {
+		size += face.getSize();
+	}
+	for (const MipLevel &face : this->faces) {
+		size += face.pixels.size();
+	}
+	for (const std::vector<MipLevel> &faceMips : this->mips) {
+		for (const MipLevel &mip : faceMips) {
+			size += mip.pixels.size();
+		}
+	}
+	return size;
+}
+
+// The direction through a point of a face, a and b running -1 to 1 along its columns
+// and rows, as GL looks cube maps up
+static glm::vec3 getFaceDirection(unsigned int face, float a, float b) {
+	switch (face) {
+	case 0: return glm::vec3(1.0f, -b, -a);
+	case 1: return glm::vec3(-1.0f, -b, a);
+	case 2: return glm::vec3(a, 1.0f, b);
+	case 3: return glm::vec3(a, -1.0f, -b);
+	case 4: return glm::vec3(a, -b, 1.0f);
+	default: return glm::vec3(-a, -b, -1.0f);
+	}
+}
+
+// Bilinear sample at x, y in pixels, wrapping around horizontally
+static void sampleBilinear(const unsigned char* pixels, int width, int height, float x, float y, unsigned char* out) {
+	x -= 0.5f;
+	y = glm::clamp(y - 0.5f, 0.0f, (float)(height - 1));
+	int x0 = (int)floorf(x), y0 = (int)y;
+	float fx = x - x0, fy = y - y0;
+
+	x0 = ((x0 % width) + width) % width;
+	int x1 = (x0 + 1) % width;
+	int y1 = std::min(y0 + 1, height - 1);
+
+	const unsigned char* p00 = &pixels[((size_t)y0 * width + x0) * 4];
+	const unsigned char* p10 = &pixels[((size_t)y0 * width + x1) * 4];
+	const unsigned char* p01 = &pixels[((size_t)y1 * width + x0) * 4];
+	const unsigned char* p11 = &pixels[((size_t)y1 * width + x1) * 4];
+	for (int c = 0; c < 4; c++) {
+		float top = p00[c] + (p10[c] - p00[c]) * fx;
+		float bottom = p01[c] + (p11[c] - p01[c]) * fx;
+		out[c] = (unsigned char)(top + (bottom - top) * fy + 0.5f);
+	}
+}
+
+int CubemapGenerator::getFaceSize(int width) {
+	// a face spans a quarter of the way around
+	return std::max((width / 4 + 3) / 4 * 4, 4);
+}
+
+unsigned int CubemapGenerator::getProjectionHash(const glm::vec3 &front, const glm::vec3 &up) {
+	const float values[] = { front.x, front.y, front.z, up.x, up.y, up.z };
+	const unsigned char* bytes = (const unsigned char*)values;
+
+	// 32-bit FNV-1a, as MappedFile::hashFile but narrower to fit a DDS header word
+	unsigned int hash = 2166136261u;
+	for (size_t i = 0; i < sizeof(values); i++) {
+		hash ^= bytes[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+void CubemapGenerator::fromEquirectangular(const unsigned char* pixels, int width, int height, const glm::vec3 &front, const glm::vec3 &up, int faceSize, std::vector<MipLevel> &faces) {
+	// an orthonormal frame, whatever rounding the caller's directions had
+	glm::vec3 upAxis = glm::normalize(up);
+	glm::vec3 frontAxis = glm::normalize(front - upAxis * glm::dot(front, upAxis));
+	glm::vec3 rightAxis = glm::cross(upAxis, frontAxis);
+
+	faces.resize(CUBEMAP_FACES);
+	for (MipLevel &face : faces) {
+		face.width = faceSize;
+		face.height = faceSize;
+		face.pixels.resize((size_t)faceSize * faceSize * 4);
+	}
+
+	unsigned int stripsPerFace = (faceSize + CUBEMAP_STRIP_ROWS - 1) / CUBEMAP_STRIP_ROWS;
+	ThreadPool::getShared().parallelFor(stripsPerFace * CUBEMAP_FACES, [&](unsigned int i) {
+		unsigned int face = i / stripsPerFace;
+		int firstRow = (i % stripsPerFace) * CUBEMAP_STRIP_ROWS;
+		int lastRow = std::min(firstRow + CUBEMAP_STRIP_ROWS, faceSize);
+
+		for (int y = firstRow; y < lastRow; y++) {
+			unsigned char* row = &faces[face].pixels[(size_t)y * faceSize * 4];
+			float b = 2.0f * (y + 0.5f) / faceSize - 1.0f;
+
+			for (int x = 0; x < faceSize; x++) {
+				float a = 2.0f * (x + 0.5f) / faceSize - 1.0f;
+				glm::vec3 direction = glm::normalize(getFaceDirection(face, a, b));
+
+				float latitude = asinf(glm::clamp(glm::dot(direction, upAxis), -1.0f, 1.0f));
+				float longitude = atan2f(glm::dot(direction, rightAxis), glm::dot(direction, frontAxis));
+				float u = longitude / (2.0f * glm::pi<float>());
+				float v = 0.5f + latitude / glm::pi<float>();
+
+				sampleBilinear(pixels, width, height, u * width, v * height, &row[x * 4]);
+			}
+		}
+	});
+}
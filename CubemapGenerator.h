@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "MipmapGenerator.h"
+#include "TextureCompressor.h"
+
+// Faces of a cube map, in the GL order +X, -X, +Y, -Y, +Z, -Z
+#define CUBEMAP_FACES 6
+
+// Rows of a face each task fills
+#define CUBEMAP_STRIP_ROWS 32
+
+// A cube map made from an image, each face with its mip chain
+struct CubemapImage {
+	std::string filename;
+	// of the source file's contents (see MappedFile::hashFile), for TextureCache
+	unsigned long long hash;
+	int faceSize;
+	// level 0 of each face, 8-bit RGBA, and levels 1 and down of each; both empty
+	// once the faces are compressed
+	std::vector<MipLevel> faces;
+	std::vector<std::vector<MipLevel>> mips;
+	// each face's DXT mip chain, if compressed
+	std::vector<CompressedImage> compressedFaces;
+	// why there are no faces
+	std::string error;
+
+	CubemapImage() : hash(0), faceSize(0) {}
+
+	// bytes of every face and level, as uploaded
+	size_t getSize() const;
+};
+
+// Projects latitude/longitude (equirectangular) images onto the faces of a cube map,
+// so a sky can be drawn as a cube rather than a finely tessellated sphere. Nothing
+// here touches GL, so it runs on loader threads.
+class CubemapGenerator {
+public:
+	// about the image's resolution around the horizon, in whole 4x4 blocks
+	static int getFaceSize(int width);
+
+	// identifies front and up, so a cache of the faces is only used for the same ones
+	static unsigned int getProjectionHash(const glm::vec3 &front, const glm::vec3 &up);
+
+	// Fills faces with 8-bit RGBA pixels as seen from the centre of the cube. The image's
+	// middle row is the horizon around up and its last row looks along up; column 0
+	// looks along front, and columns wrap around towards cross(up, front). Samples are
+	// bilinear, the faces' rows split over the shared thread pool.
+	static void fromEquirectangular(const unsigned char* pixels, int width, int height, const glm::vec3 &front, const glm::vec3 &up, int faceSize, std::vector<MipLevel> &faces);
+};
@@ -0,0 +1,88 @@
+#include "HanoiSolver.h"
+
+#ifdef _MSC_VER
+#  include <intrin.h>
+#endif
+
+static inline unsigned int countTrailingZeros(unsigned long long value) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, value);
+	return index;
+#else
+	return __builtin_ctzll(value);
+#endif
+}
+
+HanoiSolver::HanoiSolver(unsigned int numDisks) : numDisks(numDisks) {
+	for (int i = 0; i < 3; i++) {
+		this->pegs[i].reserve(numDisks);
+	}
+	this->reset();
+}
+
+HanoiMove HanoiSolver::getMove(unsigned int numDisks, unsigned long long moveIndex) {
+	// Move m (1 based) moves the disk given by the lowest set bit of m, from peg
+	// (m & (m - 1)) % 3 to peg ((m | (m - 1)) + 1) % 3. That solves onto peg 2 for an
+	// odd number of disks and onto peg 1 for an even one, so swap 1 and 2 for the latter.
+	unsigned long long m = moveIndex + 1;
+
+	HanoiMove move;
+	move.disk = countTrailingZeros(m);
+	move.from = (unsigned int)((m & (m - 1)) % 3);
+	move.to = (unsigned int)(((m | (m - 1)) + 1) % 3);
+
+	if (numDisks % 2 == 0) {
+		if (move.from != 0) move.from = 3 - move.from;
+		if (move.to != 0) move.to = 3 - move.to;
+	}
+
+	return move;
+}
+
+void HanoiSolver::reset() {
+	this->seek(0);
+}
+
+void HanoiSolver::seek(unsigned long long moveIndex) {
+	if (moveIndex > this->getNumMoves()) {
+		moveIndex = this->getNumMoves();
+	}
+	this->movesMade = moveIndex;
+
+	for (int i = 0; i < 3; i++) {
+		this->pegs[i].clear();
+	}
+
+	// Disk d has moved (k + 2^d) / 2^(d+1) times after k moves, always stepping the same
+	// way round the pegs: 0->2->1 when N - d is odd, 0->1->2 when it is even. Placing
+	// them largest first builds each peg from the bottom up.
+	for (unsigned int disk = this->numDisks; disk > 0; disk--) {
+		unsigned int d = disk - 1;
+		unsigned long long timesMoved = (moveIndex + (1ULL << d)) >> (d + 1);
+		unsigned int step = ((this->numDisks - d) % 2 == 1) ? 2 : 1;
+		unsigned int peg = (unsigned int)((timesMoved % 3) * step % 3);
+
+		this->pegs[peg].push_back(d);
+	}
+}
+
+bool HanoiSolver::nextMove(HanoiMove &move) {
+	if (this->movesMade >= this->getNumMoves()) {
+		return false;
+	}
+
+	move = getMove(this->numDisks, this->movesMade);
+
+	this->pegs[move.from].pop_back();
+	this->pegs[move.to].push_back(move.disk);
+	this->movesMade++;
+
+	return true;
+}
+
+unsigned int HanoiSolver::getNumDisks() { return this->numDisks; }
+unsigned long long HanoiSolver::getNumMoves() { return (1ULL << this->numDisks) - 1; }
+unsigned long long HanoiSolver::getMovesMade() { return this->movesMade; }
+unsigned int HanoiSolver::getPegHeight(unsigned int peg) { return this->pegs[peg].size(); }
+const std::vector<unsigned int>& HanoiSolver::getPegDisks(unsigned int peg) { return this->pegs[peg]; }
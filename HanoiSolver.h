@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+
+struct HanoiMove {
+	unsigned int disk; // 0 is the smallest disk
+	unsigned int from;
+	unsigned int to;
+};
+
+// The 2^N - 1 moves that take N disks from peg 0 to peg 2. Move k is computed
+// directly from the binary representation of k + 1, so the solution is never
+// stored and any point in it can be reached in O(N) with seek().
+class HanoiSolver {
+private:
+	unsigned int numDisks;
+	unsigned long long movesMade;
+	std::vector<unsigned int> pegs[3];
+
+public:
+	HanoiSolver(unsigned int numDisks);
+
+	// Move number moveIndex (0 based) of the numDisks solution, in O(1)
+	static HanoiMove getMove(unsigned int numDisks, unsigned long long moveIndex);
+
+	// Starts again with every disk on peg 0
+	void reset();
+
+	// Puts the disks where they are after the first moveIndex moves
+	void seek(unsigned long long moveIndex);
+
+	// Produces the next move and applies it to the pegs; false once solved
+	bool nextMove(HanoiMove &move);
+
+	unsigned int getNumDisks();
+	unsigned long long getNumMoves();
+	unsigned long long getMovesMade();
+
+	// number of disks currently on a peg, i.e. the level the next disk lands on
+	unsigned int getPegHeight(unsigned int peg);
+	// disks on a peg from the bottom up
+	const std::vector<unsigned int>& getPegDisks(unsigned int peg);
+};
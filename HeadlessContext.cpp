@@ -0,0 +1,189 @@
+#include "HeadlessContext.h"
+
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#if defined(_WIN32) || defined(__APPLE__)
+#  define HEADLESS_NO_EGL
+#else
+#  include <EGL/egl.h>
+#  include <EGL/eglext.h>
+#endif
+
+HeadlessContext::HeadlessContext() {
+	this->display = nullptr;
+	this->context = nullptr;
+	this->surface = nullptr;
+	this->framebuffer = 0;
+	this->colorRenderbuffer = 0;
+	this->depthRenderbuffer = 0;
+	this->width = 0;
+	this->height = 0;
+}
+
+HeadlessContext::~HeadlessContext() {
+	this->close();
+}
+
+#ifdef HEADLESS_NO_EGL
+
+bool HeadlessContext::open() {
+	std::cerr << "Headless rendering needs EGL, which is not available on this platform" << std::endl;
+	return false;
+}
+
+#else
+
+bool HeadlessContext::open() {
+	EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+
+	// prefer Mesa's surfaceless platform, which needs no X server or GPU device
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+		(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (getPlatformDisplay != nullptr) {
+		eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+	}
+	if (eglDisplay == EGL_NO_DISPLAY) {
+		eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
+
+	EGLint major, minor;
+	if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, &major, &minor)) {
+		std::cerr << "Could not initialize an EGL display" << std::endl;
+		return false;
+	}
+	this->display = eglDisplay;
+
+	const EGLint configAttributes[] = {
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8,
+		EGL_GREEN_SIZE, 8,
+		EGL_BLUE_SIZE, 8,
+		EGL_DEPTH_SIZE, 24,
+		EGL_NONE
+	};
+
+	EGLConfig config;
+	EGLint numConfigs = 0;
+	if (!eglChooseConfig(eglDisplay, configAttributes, &config, 1, &numConfigs) || numConfigs == 0) {
+		std::cerr << "No EGL config supports desktop OpenGL" << std::endl;
+		this->close();
+		return false;
+	}
+
+	// the shaders rely on the compatibility profile, which is what a context
+	// created without version attributes gives
+	if (!eglBindAPI(EGL_OPENGL_API)) {
+		std::cerr << "EGL cannot create desktop OpenGL contexts" << std::endl;
+		this->close();
+		return false;
+	}
+
+	EGLContext eglContext = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, nullptr);
+	if (eglContext == EGL_NO_CONTEXT) {
+		std::cerr << "Could not create an EGL context" << std::endl;
+		this->close();
+		return false;
+	}
+	this->context = eglContext;
+
+	// everything is drawn to the framebuffer object, so a surface is only made when
+	// the implementation cannot make a context current without one
+	if (!eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, eglContext)) {
+		const EGLint surfaceAttributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+		EGLSurface eglSurface = eglCreatePbufferSurface(eglDisplay, config, surfaceAttributes);
+
+		if (eglSurface == EGL_NO_SURFACE || !eglMakeCurrent(eglDisplay, eglSurface, eglSurface, eglContext)) {
+			std::cerr << "Could not make the EGL context current" << std::endl;
+			this->close();
+			return false;
+		}
+		this->surface = eglSurface;
+	}
+
+	std::cout << "Using EGL " << major << "." << minor << " (headless)" << std::endl;
+	return true;
+}
+
+#endif
+
+bool HeadlessContext::createFramebuffer(int width, int height) {
+	this->width = width;
+	this->height = height;
+
+	glGenRenderbuffers(1, &this->colorRenderbuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, this->colorRenderbuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+	glGenRenderbuffers(1, &this->depthRenderbuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, this->depthRenderbuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+	glGenFramebuffers(1, &this->framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, this->framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->colorRenderbuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, this->depthRenderbuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		std::cerr << "Offscreen framebuffer is incomplete" << std::endl;
+		return false;
+	}
+
+	// left bound; nothing else in the renderer binds framebuffers
+	return true;
+}
+
+void HeadlessContext::close() {
+	if (this->framebuffer != 0) {
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glDeleteFramebuffers(1, &this->framebuffer);
+		glDeleteRenderbuffers(1, &this->colorRenderbuffer);
+		glDeleteRenderbuffers(1, &this->depthRenderbuffer);
+		this->framebuffer = 0;
+		this->colorRenderbuffer = 0;
+		this->depthRenderbuffer = 0;
+	}
+
+#ifndef HEADLESS_NO_EGL
+	if (this->display != nullptr) {
+		eglMakeCurrent(this->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		if (this->surface != nullptr) {
+			eglDestroySurface(this->display, this->surface);
+		}
+		if (this->context != nullptr) {
+			eglDestroyContext(this->display, this->context);
+		}
+		eglTerminate(this->display);
+	}
+#endif
+
+	this->display = nullptr;
+	this->context = nullptr;
+	this->surface = nullptr;
+}
+
+bool HeadlessContext::saveFrame(const std::string filename) {
+	std::vector<unsigned char> pixels(this->width * this->height * 3);
+
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, this->width, this->height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+	std::ofstream fileOut(filename.c_str(), std::ios::binary | std::ios::trunc);
+	if (!fileOut.is_open()) {
+		std::cerr << "Could not write " << filename << std::endl;
+		return false;
+	}
+
+	fileOut << "P6\n" << this->width << " " << this->height << "\n255\n";
+
+	// GL rows start at the bottom, PPM rows at the top
+	size_t rowBytes = this->width * 3;
+	for (int y = this->height - 1; y >= 0; y--) {
+		fileOut.write((const char*)&pixels[y * rowBytes], rowBytes);
+	}
+
+	return (bool)fileOut;
+}
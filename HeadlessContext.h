@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+
+#include <GL/glew.h>
+
+// Offscreen OpenGL context for running without a window (e.g. on build hosts with
+// only Mesa's llvmpipe). It uses EGL's surfaceless platform where available, and
+// renders into a framebuffer object in place of the default framebuffer.
+//
+// open() makes the context current, so glewInit() can run after it; the framebuffer
+// needs the GL entry points, so createFramebuffer() has to come after glewInit().
+class HeadlessContext {
+private:
+	void* display; // EGLDisplay
+	void* context; // EGLContext
+	void* surface; // EGLSurface, only if surfaceless contexts are not supported
+
+	GLuint framebuffer;
+	GLuint colorRenderbuffer;
+	GLuint depthRenderbuffer;
+	int width;
+	int height;
+
+	HeadlessContext(const HeadlessContext&) = delete;
+	HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+public:
+	HeadlessContext();
+	~HeadlessContext();
+
+	bool open();
+	bool createFramebuffer(int width, int height);
+	void close();
+
+	// Writes the current contents of the framebuffer as a binary PPM
+	bool saveFrame(const std::string filename);
+};
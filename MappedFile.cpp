@@ -0,0 +1,144 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#  define WIN32_LEAN_AND_MEAN
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+MappedFile::MappedFile() {
+	this->data = nullptr;
+	this->size = 0;
+
+#ifdef _WIN32
+	this->fileHandle = INVALID_HANDLE_VALUE;
+	this->mappingHandle = nullptr;
+#else
+	this->fileDescriptor = -1;
+#endif
+}
+
+MappedFile::~MappedFile() {
+	this->close();
+}
+
+bool MappedFile::open(const std::string filename) {
+	this->close();
+
+#ifdef _WIN32
+	this->fileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (this->fileHandle == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(this->fileHandle, &fileSize)) {
+		this->close();
+		return false;
+	}
+	this->size = (size_t)fileSize.QuadPart;
+
+	// an empty file cannot be mapped, but is still a valid (empty) file
+	if (this->size == 0) {
+		return true;
+	}
+
+	this->mappingHandle = CreateFileMappingA(this->fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (this->mappingHandle == nullptr) {
+		this->close();
+		return false;
+	}
+
+	this->data = (const char*)MapViewOfFile(this->mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (this->data == nullptr) {
+		this->close();
+		return false;
+	}
+#else
+	this->fileDescriptor = ::open(filename.c_str(), O_RDONLY);
+	if (this->fileDescriptor < 0) {
+		return false;
+	}
+
+	struct stat fileStat;
+	if (fstat(this->fileDescriptor, &fileStat) != 0) {
+		this->close();
+		return false;
+	}
+	this->size = (size_t)fileStat.st_size;
+
+	// an empty file cannot be mapped, but is still a valid (empty) file
+	if (this->size == 0) {
+		return true;
+	}
+
+	void* mapping = mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, this->fileDescriptor, 0);
+	if (mapping == MAP_FAILED) {
+		this->close();
+		return false;
+	}
+	this->data = (const char*)mapping;
+
+	// we walk the file front to back exactly once
+	madvise(mapping, this->size, MADV_SEQUENTIAL);
+#endif
+
+	return true;
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+	if (this->data != nullptr) {
+		UnmapViewOfFile(this->data);
+	}
+	if (this->mappingHandle != nullptr) {
+		CloseHandle(this->mappingHandle);
+	}
+	if (this->fileHandle != INVALID_HANDLE_VALUE) {
+		CloseHandle(this->fileHandle);
+	}
+	this->mappingHandle = nullptr;
+	this->fileHandle = INVALID_HANDLE_VALUE;
+#else
+	if (this->data != nullptr) {
+		munmap((void*)this->data, this->size);
+	}
+	if (this->fileDescriptor >= 0) {
+		::close(this->fileDescriptor);
+	}
+	this->fileDescriptor = -1;
+#endif
+
+	this->data = nullptr;
+	this->size = 0;
+}
+
+bool MappedFile::isOpen() {
+#ifdef _WIN32
+	return this->fileHandle != INVALID_HANDLE_VALUE;
+#else
+	return this->fileDescriptor >= 0;
+#endif
+}
+
+const char* MappedFile::getData() { return this->data; }
+size_t MappedFile::getSize() { return this->size; }
+
+unsigned long long MappedFile::hashFile(const std::string filename) {
+	MappedFile file;
+	if (!file.open(filename)) {
+		return 0;
+	}
+
+	const unsigned char* data = (const unsigned char*)file.getData();
+	unsigned long long hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < file.getSize(); i++) {
+		hash ^= data[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file. The contents stay valid until
+// close() is called or the object is destroyed.
+class MappedFile {
+private:
+	const char* data;
+	size_t size;
+
+#ifdef _WIN32
+	void* fileHandle;
+	void* mappingHandle;
+#else
+	int fileDescriptor;
+#endif
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+public:
+	MappedFile();
+	~MappedFile();
+
+	bool open(const std::string filename);
+	void close();
+
+	bool isOpen();
+	const char* getData();
+	size_t getSize();
+
+	// 64-bit FNV-1a of the whole file, 0 if it cannot be read
+	static unsigned long long hashFile(const std::string filename);
+};
@@ -0,0 +1,149 @@
+#include "MeshCache.h"
+#include "MappedFile.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+static bool getFileInfo(const std::string &filename, unsigned long long &size, long long &modifiedTime) {
+	struct stat fileStat;
+	if (stat(filename.c_str(), &fileStat) != 0) {
+		return false;
+	}
+
+	size = (unsigned long long)fileStat.st_size;
+	modifiedTime = (long long)fileStat.st_mtime;
+	return true;
+}
+
+// Records a new source timestamp in a cache whose contents were found to still match,
+// so later reads pass the cheap check again; a failure only costs the hash next time
+static void updateModifiedTime(const std::string &cacheFilename, long long modifiedTime) {
+	std::fstream file(cacheFilename.c_str(), std::ios::binary | std::ios::in | std::ios::out);
+	if (!file.is_open()) {
+		return;
+	}
+
+	file.seekp(offsetof(MeshCacheHeader, sourceModifiedTime));
+	file.write((const char*)&modifiedTime, sizeof(modifiedTime));
+}
+
+std::string MeshCache::getCacheFilename(const std::string sourceFilename) {
+	return sourceFilename + ".bin";
+}
+
+bool MeshCache::read(const std::string cacheFilename, const std::string sourceFilename, const unsigned int flags, ObjMesh &mesh) {
+	MappedFile file;
+	if (!file.open(cacheFilename) || file.getSize() < sizeof(MeshCacheHeader)) {
+		return false;
+	}
+
+	MeshCacheHeader header;
+	memcpy(&header, file.getData(), sizeof(header));
+
+	if (memcmp(header.magic, MESH_CACHE_MAGIC, 4) != 0 || header.version != MESH_CACHE_VERSION || header.flags != flags) {
+		return false;
+	}
+
+	size_t vertexBytes = (size_t)header.numIndexedVertices * sizeof(Vertex);
+	size_t indexBytes = (size_t)header.numTriangles * 3 * sizeof(unsigned int);
+	if (file.getSize() != sizeof(MeshCacheHeader) + vertexBytes + indexBytes) {
+		return false;
+	}
+
+	// the timestamp is the cheap check; if only it changed (e.g. a fresh checkout)
+	// fall back to comparing the contents
+	unsigned long long sourceSize;
+	long long sourceModifiedTime;
+	if (!getFileInfo(sourceFilename, sourceSize, sourceModifiedTime) || sourceSize != header.sourceSize) {
+		return false;
+	}
+	if (sourceModifiedTime != header.sourceModifiedTime && MappedFile::hashFile(sourceFilename) != header.sourceHash) {
+		return false;
+	}
+
+	const Vertex* vertices = (const Vertex*)(file.getData() + sizeof(MeshCacheHeader));
+	const unsigned int* indices = (const unsigned int*)(file.getData() + sizeof(MeshCacheHeader) + vertexBytes);
+
+	// a damaged cache must not reach glDrawElements with indices past the vertices
+	for (size_t i = 0; i < (size_t)header.numTriangles * 3; i++) {
+		if (indices[i] >= header.numIndexedVertices) {
+			return false;
+		}
+	}
+
+	mesh.numVertices = header.numVertices;
+	mesh.numIndexedVertices = header.numIndexedVertices;
+	mesh.numTriangles = header.numTriangles;
+	mesh.centre = header.centre;
+	mesh.dimensions = header.dimensions;
+	mesh.acmrBefore = header.acmrBefore;
+	mesh.acmrAfter = header.acmrAfter;
+
+	mesh.indexedPositions.resize(header.numIndexedVertices);
+	mesh.indexedNormals.resize(header.numIndexedVertices);
+	mesh.indexedTextureCoords.resize(header.numIndexedVertices);
+	for (unsigned int i = 0; i < header.numIndexedVertices; i++) {
+		mesh.indexedPositions[i] = vertices[i].position;
+		mesh.indexedNormals[i] = vertices[i].normal;
+		mesh.indexedTextureCoords[i] = vertices[i].textureCoord;
+	}
+
+	mesh.triangleIndices.assign(indices, indices + header.numTriangles * 3);
+
+	if (sourceModifiedTime != header.sourceModifiedTime) {
+		file.close();
+		updateModifiedTime(cacheFilename, sourceModifiedTime);
+	}
+
+	return true;
+}
+
+bool MeshCache::write(const std::string cacheFilename, const std::string sourceFilename, const unsigned int flags, ObjMesh &mesh) {
+	MeshCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, MESH_CACHE_MAGIC, 4);
+	header.version = MESH_CACHE_VERSION;
+	header.flags = flags;
+	header.numVertices = mesh.numVertices;
+	header.numIndexedVertices = mesh.numIndexedVertices;
+	header.numTriangles = mesh.numTriangles;
+	header.centre = mesh.centre;
+	header.dimensions = mesh.dimensions;
+	header.acmrBefore = mesh.acmrBefore;
+	header.acmrAfter = mesh.acmrAfter;
+
+	if (!getFileInfo(sourceFilename, header.sourceSize, header.sourceModifiedTime)) {
+		return false;
+	}
+	header.sourceHash = MappedFile::hashFile(sourceFilename);
+
+	std::vector<Vertex> vertices;
+	mesh.getVertices(vertices);
+
+	// write to a temporary file first so a reader never maps a half written cache
+	std::string temporaryFilename = cacheFilename + ".tmp";
+	std::ofstream fileOut(temporaryFilename.c_str(), std::ios::binary | std::ios::trunc);
+
+	if (!fileOut.is_open()) {
+		return false;
+	}
+
+	fileOut.write((const char*)&header, sizeof(header));
+	fileOut.write((const char*)vertices.data(), vertices.size() * sizeof(Vertex));
+	fileOut.write((const char*)mesh.triangleIndices.data(), mesh.triangleIndices.size() * sizeof(unsigned int));
+	fileOut.close();
+
+	if (!fileOut) {
+		remove(temporaryFilename.c_str());
+		return false;
+	}
+
+	remove(cacheFilename.c_str());
+	return rename(temporaryFilename.c_str(), cacheFilename.c_str()) == 0;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+
+#include "ObjMesh.h"
+
+// Binary cache of a loaded ObjMesh, written next to the source .obj so later runs
+// can map it instead of parsing text. The file is laid out as:
+//
+//   MeshCacheHeader
+//   Vertex[numIndexedVertices]            interleaved position/normal/uv
+//   unsigned int[numTriangles * 3]        triangle indices
+//
+// All values are stored in the host's (little endian) byte order.
+
+#define MESH_CACHE_MAGIC "HMSH"
+#define MESH_CACHE_VERSION 3
+
+#define MESH_CACHE_AUTO_CENTRE 0x1
+#define MESH_CACHE_AUTO_NORMALIZE 0x2
+#define MESH_CACHE_OPTIMIZED 0x4
+
+struct MeshCacheHeader {
+	char magic[4];
+	unsigned int version;
+	unsigned int flags;
+
+	unsigned int numVertices;
+	unsigned int numIndexedVertices;
+	unsigned int numTriangles;
+
+	// identifies the .obj the cache was built from
+	unsigned long long sourceSize;
+	long long sourceModifiedTime;
+	unsigned long long sourceHash;
+
+	// bounds of the source positions, as reported by ObjMesh
+	Vector3 centre;
+	Vector3 dimensions;
+
+	// vertex cache miss ratios before and after ObjMesh::optimize, 0 if it was not run
+	float acmrBefore;
+	float acmrAfter;
+};
+
+class MeshCache {
+public:
+	static std::string getCacheFilename(const std::string sourceFilename);
+
+	// Fills the mesh from cacheFilename if it was built from the current contents of
+	// sourceFilename with the same flags. Returns false if the cache is missing or stale.
+	static bool read(const std::string cacheFilename, const std::string sourceFilename, const unsigned int flags, ObjMesh &mesh);
+
+	static bool write(const std::string cacheFilename, const std::string sourceFilename, const unsigned int flags, ObjMesh &mesh);
+};
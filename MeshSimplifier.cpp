@@ -0,0 +1,470 @@
+#include "MeshSimplifier.h"
+#include "ObjMesh.h"
+#include "VertexCacheOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+// Sum of squared distances to a set of planes, kept as the symmetric 4x4 matrix
+// (a, b, c, d)(a, b, c, d)^T; weight is the total area the planes stand for
+struct Quadric {
+	double a2, b2, c2, d2;
+	double ab, ac, ad, bc, bd, cd;
+	double weight;
+};
+
+enum VertexKind {
+	// the only vertex at its position
+	KIND_MANIFOLD,
+	// one of exactly two vertices at a position, with a different normal or uv
+	KIND_SEAM,
+	// on an open border, or where more than two copies meet
+	KIND_LOCKED
+};
+
+struct Collapse {
+	unsigned int from;
+	unsigned int to;
+	double cost;
+};
+
+static unsigned long long edgeKey(unsigned int a, unsigned int b) {
+	return a < b ? ((unsigned long long)a << 32) | b : ((unsigned long long)b << 32) | a;
+}
+
+static void addPlane(Quadric &q, double a, double b, double c, double d, double weight) {
+	q.a2 += a * a * weight;
+	q.b2 += b * b * weight;
+	q.c2 += c * c * weight;
+	q.d2 += d * d * weight;
+	q.ab += a * b * weight;
+	q.ac += a * c * weight;
+	q.ad += a * d * weight;
+	q.bc += b * c * weight;
+	q.bd += b * d * weight;
+	q.cd += c * d * weight;
+	q.weight += weight;
+}
+
+static void addQuadric(Quadric &q, const Quadric &other) {
+	q.a2 += other.a2;
+	q.b2 += other.b2;
+	q.c2 += other.c2;
+	q.d2 += other.d2;
+	q.ab += other.ab;
+	q.ac += other.ac;
+	q.ad += other.ad;
+	q.bc += other.bc;
+	q.bd += other.bd;
+	q.cd += other.cd;
+	q.weight += other.weight;
+}
+
+static double evaluate(const Quadric &q, const Vector3 &p) {
+	double x = p.x, y = p.y, z = p.z;
+	double result = q.a2 * x * x + q.b2 * y * y + q.c2 * z * z + q.d2
+		+ 2.0 * (q.ab * x * y + q.ac * x * z + q.bc * y * z + q.ad * x + q.bd * y + q.cd * z);
+	return std::max(result, 0.0);
+}
+
+static void cross(const Vector3 &a, const Vector3 &b, const Vector3 &c, double normal[3]) {
+	double e1[3] = { (double)b.x - a.x, (double)b.y - a.y, (double)b.z - a.z };
+	double e2[3] = { (double)c.x - a.x, (double)c.y - a.y, (double)c.z - a.z };
+	normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+	normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+	normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+static bool samePosition(const Vector3 &a, const Vector3 &b) {
+	return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+MeshSimplifier::MeshSimplifier(const Vertex *vertices, unsigned int numVertices, const unsigned int *triangleIndices, unsigned int numTriangles) {
+	this->vertices.assign(vertices, vertices + numVertices);
+	this->triangleIndices.assign(triangleIndices, triangleIndices + numTriangles * 3);
+	this->error = 0.0f;
+}
+
+MeshSimplifier::MeshSimplifier(ObjMesh &mesh) {
+	mesh.getVertices(this->vertices);
+	this->triangleIndices.assign(mesh.getTriangleIndices(), mesh.getTriangleIndices() + mesh.getNumTriangles() * 3);
+	this->error = 0.0f;
+}
+
+void MeshSimplifier::simplify(unsigned int targetTriangles) {
+	std::vector<unsigned int> &indices = this->triangleIndices;
+	unsigned int numVertices = this->vertices.size();
+
+	// Vertices at exactly the same position share a position id, and the quadric
+	// lives with the position so both sides of a seam measure the same error
+	std::vector<unsigned int> order(numVertices);
+	for (unsigned int i = 0; i < numVertices; i++) {
+		order[i] = i;
+	}
+	std::sort(order.begin(), order.end(), [this](unsigned int a, unsigned int b) {
+		const Vector3 &pa = this->vertices[a].position;
+		const Vector3 &pb = this->vertices[b].position;
+		if (pa.x != pb.x) return pa.x < pb.x;
+		if (pa.y != pb.y) return pa.y < pb.y;
+		return pa.z < pb.z;
+	});
+
+	std::vector<unsigned int> positionIds(numVertices);
+	std::vector<unsigned int> positionStart;
+	for (unsigned int i = 0; i < numVertices; i++) {
+		if (i == 0 || !samePosition(this->vertices[order[i]].position, this->vertices[order[i - 1]].position)) {
+			positionStart.push_back(i);
+		}
+		positionIds[order[i]] = positionStart.size() - 1;
+	}
+	unsigned int numPositions = positionStart.size();
+	positionStart.push_back(numVertices);
+	// the vertices at position p are order[positionStart[p]] .. order[positionStart[p + 1] - 1]
+
+	// an edge between two positions with only one triangle is an open border
+	std::unordered_map<unsigned long long, unsigned int> positionEdges;
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		for (int e = 0; e < 3; e++) {
+			positionEdges[edgeKey(positionIds[indices[i + e]], positionIds[indices[i + (e + 1) % 3]])]++;
+		}
+	}
+
+	std::vector<VertexKind> kinds(numVertices);
+	for (unsigned int v = 0; v < numVertices; v++) {
+		unsigned int copies = positionStart[positionIds[v] + 1] - positionStart[positionIds[v]];
+		kinds[v] = copies == 1 ? KIND_MANIFOLD : (copies == 2 ? KIND_SEAM : KIND_LOCKED);
+	}
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		for (int e = 0; e < 3; e++) {
+			unsigned int a = indices[i + e], b = indices[i + (e + 1) % 3];
+			if (positionEdges[edgeKey(positionIds[a], positionIds[b])] == 1) {
+				kinds[a] = KIND_LOCKED;
+				kinds[b] = KIND_LOCKED;
+			}
+		}
+	}
+
+	// Plane of every triangle, weighted by its area, plus a plane standing up from each
+	// edge only one triangle uses (a seam or border) so collapses keep those lines straight
+	std::unordered_map<unsigned long long, unsigned int> edges;
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		for (int e = 0; e < 3; e++) {
+			edges[edgeKey(indices[i + e], indices[i + (e + 1) % 3])]++;
+		}
+	}
+
+	std::vector<Quadric> quadrics(numPositions, Quadric());
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		const Vector3 *p[3] = { &this->vertices[indices[i]].position, &this->vertices[indices[i + 1]].position, &this->vertices[indices[i + 2]].position };
+
+		double normal[3];
+		cross(*p[0], *p[1], *p[2], normal);
+		double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if (length == 0.0) {
+			continue;
+		}
+		normal[0] /= length;
+		normal[1] /= length;
+		normal[2] /= length;
+		double area = length * 0.5;
+
+		Quadric q = Quadric();
+		addPlane(q, normal[0], normal[1], normal[2], -(normal[0] * p[0]->x + normal[1] * p[0]->y + normal[2] * p[0]->z), area);
+		for (int c = 0; c < 3; c++) {
+			addQuadric(quadrics[positionIds[indices[i + c]]], q);
+		}
+
+		for (int e = 0; e < 3; e++) {
+			unsigned int a = indices[i + e], b = indices[i + (e + 1) % 3];
+			if (edges[edgeKey(a, b)] != 1) {
+				continue;
+			}
+
+			const Vector3 &pa = *p[e], &pb = *p[(e + 1) % 3];
+			double edge[3] = { (double)pb.x - pa.x, (double)pb.y - pa.y, (double)pb.z - pa.z };
+			double side[3] = { edge[1] * normal[2] - edge[2] * normal[1], edge[2] * normal[0] - edge[0] * normal[2], edge[0] * normal[1] - edge[1] * normal[0] };
+			double sideLength = std::sqrt(side[0] * side[0] + side[1] * side[1] + side[2] * side[2]);
+			if (sideLength == 0.0) {
+				continue;
+			}
+			side[0] /= sideLength;
+			side[1] /= sideLength;
+			side[2] /= sideLength;
+
+			Quadric border = Quadric();
+			addPlane(border, side[0], side[1], side[2], -(side[0] * pa.x + side[1] * pa.y + side[2] * pa.z), sideLength);
+			addQuadric(quadrics[positionIds[a]], border);
+			addQuadric(quadrics[positionIds[b]], border);
+		}
+	}
+
+	unsigned int numTriangles = indices.size() / 3;
+	bool takeAll = false;
+
+	while (numTriangles > targetTriangles) {
+		// triangles around each vertex, rebuilt at the start of every pass
+		std::vector<unsigned int> triangleStart(numVertices + 1, 0);
+		for (unsigned int index : indices) {
+			triangleStart[index + 1]++;
+		}
+		for (unsigned int v = 0; v < numVertices; v++) {
+			triangleStart[v + 1] += triangleStart[v];
+		}
+		std::vector<unsigned int> vertexTriangles(indices.size());
+		std::vector<unsigned int> fill(triangleStart.begin(), triangleStart.end() - 1);
+		for (size_t i = 0; i < indices.size(); i++) {
+			vertexTriangles[fill[indices[i]]++] = i / 3;
+		}
+
+		// the number of triangles with both from and to, i.e. using that edge
+		auto countShared = [&](unsigned int from, unsigned int to) {
+			unsigned int count = 0;
+			for (unsigned int t = triangleStart[from]; t < triangleStart[from + 1]; t++) {
+				const unsigned int *triangle = &indices[vertexTriangles[t] * 3];
+				count += (triangle[0] == to || triangle[1] == to || triangle[2] == to) ? 1 : 0;
+			}
+			return count;
+		};
+
+		// the cheapest way for each vertex to go
+		std::vector<Collapse> best(numVertices, Collapse{ 0, 0, -1.0 });
+		for (size_t i = 0; i < indices.size(); i += 3) {
+			for (int e = 0; e < 6; e++) {
+				unsigned int from = indices[i + e % 3];
+				unsigned int to = indices[i + (e < 3 ? (e + 1) % 3 : (e + 2) % 3)];
+
+				if (kinds[from] == KIND_LOCKED || (kinds[from] == KIND_SEAM && kinds[to] == KIND_MANIFOLD)) {
+					continue;
+				}
+				if (kinds[from] == KIND_SEAM && countShared(from, to) != 1) {
+					continue;
+				}
+
+				Quadric q = quadrics[positionIds[from]];
+				addQuadric(q, quadrics[positionIds[to]]);
+				double cost = evaluate(q, this->vertices[to].position);
+
+				if (best[from].cost < 0.0 || cost < best[from].cost) {
+					best[from] = Collapse{ from, to, cost };
+				}
+			}
+		}
+
+		std::vector<Collapse> collapses;
+		for (const Collapse &collapse : best) {
+			if (collapse.cost >= 0.0) {
+				collapses.push_back(collapse);
+			}
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse &a, const Collapse &b) {
+			return a.cost < b.cost;
+		});
+
+		// only the cheaper half goes each pass, so the error grows gradually; the rest
+		// are priced again next pass against the simplified neighbourhood
+		size_t limit = takeAll ? collapses.size() : (collapses.size() + 1) / 2;
+
+		std::vector<unsigned int> remap(numVertices);
+		for (unsigned int v = 0; v < numVertices; v++) {
+			remap[v] = v;
+		}
+		// positions whose neighbourhood changed this pass and must wait for the next
+		std::vector<bool> touched(numPositions, false);
+		unsigned int numCollapsed = 0;
+
+		// the position ids around every copy of a position
+		auto getNeighbours = [&](unsigned int position, std::vector<unsigned int> &neighbours) {
+			neighbours.clear();
+			for (unsigned int k = positionStart[position]; k < positionStart[position + 1]; k++) {
+				unsigned int v = order[k];
+				for (unsigned int t = triangleStart[v]; t < triangleStart[v + 1]; t++) {
+					for (int c = 0; c < 3; c++) {
+						unsigned int other = positionIds[indices[vertexTriangles[t] * 3 + c]];
+						if (other != position) {
+							neighbours.push_back(other);
+						}
+					}
+				}
+			}
+			std::sort(neighbours.begin(), neighbours.end());
+			neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+		};
+
+		// moving from onto to must not turn any remaining triangle over or flatten it
+		auto keepsOrientation = [&](unsigned int from, unsigned int to) {
+			for (unsigned int t = triangleStart[from]; t < triangleStart[from + 1]; t++) {
+				const unsigned int *triangle = &indices[vertexTriangles[t] * 3];
+				if (triangle[0] == to || triangle[1] == to || triangle[2] == to) {
+					continue;
+				}
+
+				Vector3 moved[3];
+				for (int c = 0; c < 3; c++) {
+					moved[c] = this->vertices[triangle[c] == from ? to : triangle[c]].position;
+				}
+
+				double before[3], after[3];
+				cross(this->vertices[triangle[0]].position, this->vertices[triangle[1]].position, this->vertices[triangle[2]].position, before);
+				cross(moved[0], moved[1], moved[2], after);
+
+				double dot = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+				double afterLength = std::sqrt(after[0] * after[0] + after[1] * after[1] + after[2] * after[2]);
+				double beforeLength = std::sqrt(before[0] * before[0] + before[1] * before[1] + before[2] * before[2]);
+				if (afterLength <= beforeLength * 1e-6 || dot <= 0.0) {
+					return false;
+				}
+			}
+			return true;
+		};
+
+		std::vector<unsigned int> fromNeighbours, toNeighbours;
+		for (size_t i = 0; i < limit && numTriangles > targetTriangles; i++) {
+			unsigned int from = collapses[i].from;
+			unsigned int to = collapses[i].to;
+			unsigned int fromPosition = positionIds[from];
+			unsigned int toPosition = positionIds[to];
+
+			if (touched[fromPosition] || touched[toPosition]) {
+				continue;
+			}
+
+			// a seam vertex takes its twin along, onto the copy of to on the twin's side
+			unsigned int twin = from, twinTo = to;
+			if (kinds[from] == KIND_SEAM) {
+				twin = order[positionStart[fromPosition]] == from ? order[positionStart[fromPosition] + 1] : order[positionStart[fromPosition]];
+				twinTo = numVertices;
+				for (unsigned int t = triangleStart[twin]; t < triangleStart[twin + 1] && twinTo == numVertices; t++) {
+					for (int c = 0; c < 3; c++) {
+						unsigned int corner = indices[vertexTriangles[t] * 3 + c];
+						if (positionIds[corner] == toPosition && corner != to) {
+							twinTo = corner;
+						}
+					}
+				}
+				if (twinTo == numVertices || countShared(twin, twinTo) != 1) {
+					continue;
+				}
+			}
+
+			// positions around both ends may only meet across the triangles being removed,
+			// or the collapse would pinch the surface into a non-manifold edge
+			getNeighbours(fromPosition, fromNeighbours);
+			getNeighbours(toPosition, toNeighbours);
+			unsigned int numCommon = 0;
+			for (unsigned int neighbour : fromNeighbours) {
+				numCommon += std::binary_search(toNeighbours.begin(), toNeighbours.end(), neighbour) ? 1 : 0;
+			}
+			unsigned int removed = countShared(from, to) + (twin != from ? countShared(twin, twinTo) : 0);
+			if (numCommon != (twin != from ? 2u : removed) || numCommon > 2) {
+				continue;
+			}
+
+			if (!keepsOrientation(from, to) || (twin != from && !keepsOrientation(twin, twinTo))) {
+				continue;
+			}
+
+			remap[from] = to;
+			remap[twin] = twinTo;
+			this->error = std::max(this->error, (float)std::sqrt(collapses[i].cost / std::max(quadrics[fromPosition].weight + quadrics[toPosition].weight, 1e-30)));
+			addQuadric(quadrics[toPosition], quadrics[fromPosition]);
+
+			touched[toPosition] = true;
+			for (unsigned int neighbour : fromNeighbours) {
+				touched[neighbour] = true;
+			}
+			touched[fromPosition] = true;
+
+			numTriangles -= removed;
+			numCollapsed++;
+		}
+
+		if (numCollapsed == 0) {
+			if (takeAll) {
+				// every remaining collapse would fold or pinch the surface
+				break;
+			}
+			takeAll = true;
+			continue;
+		}
+		takeAll = false;
+
+		// drop the triangles that collapsed to a line
+		size_t write = 0;
+		for (size_t i = 0; i < indices.size(); i += 3) {
+			unsigned int a = remap[indices[i]], b = remap[indices[i + 1]], c = remap[indices[i + 2]];
+			if (a != b && b != c && a != c) {
+				indices[write++] = a;
+				indices[write++] = b;
+				indices[write++] = c;
+			}
+		}
+		indices.resize(write);
+		numTriangles = indices.size() / 3;
+	}
+
+	// the surviving triangles are still in their original order, which the collapses
+	// have scattered over the vertex cache; this also drops the unused vertices
+	VertexCacheOptimizer::optimizeTriangleOrder(indices.data(), indices.size() / 3, numVertices);
+
+	std::vector<unsigned int> remap;
+	std::vector<Vertex> usedVertices(VertexCacheOptimizer::optimizeVertexOrder(indices.data(), indices.size() / 3, numVertices, remap));
+	for (unsigned int v = 0; v < numVertices; v++) {
+		if (remap[v] < usedVertices.size()) {
+			usedVertices[remap[v]] = this->vertices[v];
+		}
+	}
+	this->vertices.swap(usedVertices);
+}
+
+const std::vector<Vertex>& MeshSimplifier::getVertices() {
+	return this->vertices;
+}
+
+unsigned int MeshSimplifier::getNumVertices() {
+	return this->vertices.size();
+}
+
+unsigned int MeshSimplifier::getNumTriangles() {
+	return this->triangleIndices.size() / 3;
+}
+
+unsigned int* MeshSimplifier::getTriangleIndices() {
+	return this->triangleIndices.data();
+}
+
+float MeshSimplifier::getError() {
+	return this->error;
+}
+
+void MeshSimplifier::save(const std::string filename) {
+	std::cout << "Saving geometry to " << filename << std::endl;
+
+	std::ofstream fileOut(filename.c_str());
+
+	if (!fileOut.is_open()) {
+		return;
+	}
+
+	for (const Vertex &vertex : this->vertices) {
+		fileOut << "v " << vertex.position.x << " " << vertex.position.y << " " << vertex.position.z << std::endl;
+	}
+
+	for (const Vertex &vertex : this->vertices) {
+		fileOut << "vt " << vertex.textureCoord.u << " " << vertex.textureCoord.v << std::endl;
+	}
+
+	for (const Vertex &vertex : this->vertices) {
+		fileOut << "vn " << vertex.normal.x << " " << vertex.normal.y << " " << vertex.normal.z << std::endl;
+	}
+
+	for (size_t i = 0; i < this->triangleIndices.size(); i += 3) {
+		fileOut << "f " << this->triangleIndices[i] + 1 << "/" << this->triangleIndices[i] + 1 << "/" << this->triangleIndices[i] + 1 << " ";
+		fileOut << this->triangleIndices[i + 1] + 1 << "/" << this->triangleIndices[i + 1] + 1 << "/" << this->triangleIndices[i + 1] + 1 << " ";
+		fileOut << this->triangleIndices[i + 2] + 1 << "/" << this->triangleIndices[i + 2] + 1 << "/" << this->triangleIndices[i + 2] + 1 << std::endl;
+	}
+
+	fileOut.close();
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "VertexFormat.h"
+
+class ObjMesh;
+
+// Reduces a welded, indexed mesh towards a target triangle count by collapsing edges in
+// order of quadric error (Garland & Heckbert). Collapses are half-edge: a vertex moves onto
+// one of its neighbours, so every surviving vertex keeps its original position, normal
+// and uv and no attributes have to be interpolated.
+//
+// Vertices that share a position with a differing normal or uv lie on a seam. They only
+// collapse along the seam, together with their twin on the other side, so seams stay
+// closed; corners where more than two copies meet, and open borders, never move.
+class MeshSimplifier {
+private:
+	std::vector<Vertex> vertices;
+	std::vector<unsigned int> triangleIndices;
+	float error;
+
+public:
+	MeshSimplifier(const Vertex *vertices, unsigned int numVertices, const unsigned int *triangleIndices, unsigned int numTriangles);
+	MeshSimplifier(ObjMesh &mesh);
+
+	// Collapses edges until at most targetTriangles remain, or no collapse is left that
+	// keeps the surface from folding over. Can be called again with a lower target.
+	void simplify(unsigned int targetTriangles);
+
+	// the vertices still referenced by the triangles
+	const std::vector<Vertex>& getVertices();
+	unsigned int getNumVertices();
+	unsigned int getNumTriangles();
+	unsigned int* getTriangleIndices();
+
+	// root mean square distance from the original surface of the worst collapse, in model units
+	float getError();
+
+	void save(const std::string filename);
+};
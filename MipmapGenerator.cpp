@@ -0,0 +1,49 @@
+#include "MipmapGenerator.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+void MipmapGenerator::generate(const unsigned char* pixels, int width, int height, int filter, bool srgb, std::vector<MipLevel> &levels) {
+	// reserved up front, so source stays valid as levels are added
+	size_t numLevels = 0;
+	for (int w = width, h = height; w > 1 || h > 1; w = std::max(w / 2, 1), h = std::max(h / 2, 1)) {
+		numLevels++;
+	}
+	levels.reserve(levels.size() + numLevels);
+
+	const unsigned char* source = pixels;
+	int sourceWidth = width, sourceHeight = height;
+
+	while (sourceWidth > 1 || sourceHeight > 1) {
+		levels.push_back(MipLevel());
+		MipLevel &level = levels.back();
+		level.width = std::max(sourceWidth / 2, 1);
+		level.height = std::max(sourceHeight / 2, 1);
+		level.pixels.resize((size_t)level.width * level.height * 4);
+
+		unsigned int numStrips = (level.height + MIPMAP_STRIP_ROWS - 1) / MIPMAP_STRIP_ROWS;
+		ThreadPool::getShared().parallelFor(numStrips, [&level, source, sourceWidth, sourceHeight, filter, srgb](unsigned int i) {
+			int firstRow = i * MIPMAP_STRIP_ROWS;
+			int numRows = std::min(MIPMAP_STRIP_ROWS, level.height - firstRow);
+			mipmap_image_filtered(source, sourceWidth, sourceHeight, 4, level.pixels.data(), filter, srgb ? 1 : 0, firstRow, numRows);
+		});
+
+		source = level.pixels.data();
+		sourceWidth = level.width;
+		sourceHeight = level.height;
+	}
+}
+
+int MipmapGenerator::parseFilter(const std::string name) {
+	if (name == "box") {
+		return MIPMAP_FILTER_BOX;
+	}
+	if (name == "kaiser") {
+		return MIPMAP_FILTER_KAISER;
+	}
+	return -1;
+}
+
+const char* MipmapGenerator::getFilterName(int filter) {
+	return filter == MIPMAP_FILTER_KAISER ? "kaiser" : "box";
+}
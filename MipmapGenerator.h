@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <soil/src/image_helper.h>
+
+// Rows of a level each task filters
+#define MIPMAP_STRIP_ROWS 32
+
+// One level below the top of a mip chain, 8-bit RGBA
+struct MipLevel {
+	int width;
+	int height;
+	std::vector<unsigned char> pixels;
+};
+
+// Builds mip chains on the CPU with image_helper's gamma-correct filters, so loader
+// threads can do the work and the GL thread only uploads finished levels. Each level
+// is filtered from the one above it, its rows split over the shared thread pool.
+class MipmapGenerator {
+public:
+	// Appends levels 1 down to 1x1 of 8-bit RGBA pixels (level 0 is the image itself).
+	// filter is MIPMAP_FILTER_BOX or MIPMAP_FILTER_KAISER; with srgb the color is
+	// filtered in linear light. Safe to call from a worker.
+	static void generate(const unsigned char* pixels, int width, int height, int filter, bool srgb, std::vector<MipLevel> &levels);
+
+	// "box" or "kaiser", -1 for anything else
+	static int parseFilter(const std::string name);
+	static const char* getFilterName(int filter);
+};
@@ -4,9 +4,26 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <limits>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 #include "ObjMesh.h"
+#include "MappedFile.h"
+#include "MeshCache.h"
+#include "ThreadPool.h"
+#include "VertexCacheOptimizer.h"
+
+// Raw contents of an .obj file, before any centring or indexing
+struct ObjFileData {
+	std::vector<Vector3> vertexPositions;
+	std::vector<Vector2> vertexTextureCoords;
+	std::vector<Vector3> vertexNormals;
+	std::vector<unsigned int> positionIndices;
+	std::vector<unsigned int> textureCoordIndices;
+	std::vector<unsigned int> normalIndices;
+};
 
 struct Triangle {
 	int a, b, c;
@@ -30,40 +47,309 @@ static inline void trim(std::string &s) {
 	rtrim(s);
 }
 
-ObjMesh::ObjMesh() {
-	this->numVertices = 0;
-	this->numTriangles = 0;
+// Exact powers of ten for the float fast path; 10^10 is the largest that fits a float mantissa
+static const float powersOfTen[] = {
+	1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+
+static const unsigned int EMPTY_SLOT = 0xffffffffu;
+
+// Files smaller than this are parsed on the calling thread
+static const size_t PARALLEL_PARSE_MIN_BYTES = 1 << 20;
+
+// Hash of a face corner's (position, texture coordinate, normal) index triple
+static inline unsigned int hashCorner(unsigned int position, unsigned int textureCoord, unsigned int normal) {
+	unsigned int h = (position * 73856093u) ^ (textureCoord * 19349663u) ^ (normal * 83492791u);
+	return h ^ (h >> 15);
 }
 
-void ObjMesh::load(const std::string filename, const bool autoCentre = false, const bool autoNormalize = false) {
-	std::cout << "Loading " << filename.c_str() << "..." << std::endl;
+static inline bool isBlank(char ch) {
+	return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\v' || ch == '\f';
+}
 
-	std::ifstream fileIn(filename);
+static inline void skipBlanks(const char* &p, const char* end) {
+	while (p < end && isBlank(*p)) {
+		p++;
+	}
+}
 
-	if (!fileIn.is_open()) {
-		return;
+// Parses a float in place. When the decimal mantissa and exponent are both exactly
+// representable a single multiply/divide gives the correctly rounded result, which is
+// what strtof (and so the stream parser) returns; anything else goes through strtof.
+static bool parseFloat(const char* &p, const char* end, float &out) {
+	skipBlanks(p, end);
+
+	const char* start = p;
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+')) {
+		negative = (*p == '-');
+		p++;
 	}
 
-	std::vector<Vector3> vertexPositions;
-	std::vector<Vector2> vertexTextureCoords;
-	std::vector<Vector3> vertexNormals;
-	std::vector<unsigned int> positionIndices;
-	std::vector<unsigned int> textureCoordIndices;
-	std::vector<unsigned int> normalIndices;
+	unsigned long long mantissa = 0;
+	int numDigits = 0;
+	int exponent = 0;
+	bool anyDigits = false;
 
-	numTriangles = 0;
+	while (p < end && *p >= '0' && *p <= '9') {
+		if (numDigits < 19) {
+			mantissa = mantissa * 10 + (*p - '0');
+			if (mantissa != 0) numDigits++;
+		}
+		else {
+			exponent++;
+		}
+		anyDigits = true;
+		p++;
+	}
+	if (p < end && *p == '.') {
+		p++;
+		while (p < end && *p >= '0' && *p <= '9') {
+			if (numDigits < 19) {
+				mantissa = mantissa * 10 + (*p - '0');
+				if (mantissa != 0) numDigits++;
+				exponent--;
+			}
+			anyDigits = true;
+			p++;
+		}
+	}
+	if (anyDigits && p < end && (*p == 'e' || *p == 'E')) {
+		const char* exponentStart = p++;
+		bool negativeExponent = false;
+		if (p < end && (*p == '-' || *p == '+')) {
+			negativeExponent = (*p == '-');
+			p++;
+		}
+		if (p < end && *p >= '0' && *p <= '9') {
+			int value = 0;
+			while (p < end && *p >= '0' && *p <= '9') {
+				if (value < 10000) value = value * 10 + (*p - '0');
+				p++;
+			}
+			exponent += negativeExponent ? -value : value;
+		}
+		else {
+			// not an exponent after all ("1e" or "1e+")
+			p = exponentStart;
+		}
+	}
 
-	// for auto-centering
-	float totalX = 0.0f;
-	float totalY = 0.0f;
-	float totalZ = 0.0f;
+	if (anyDigits && mantissa <= (1u << 24) && exponent >= -10 && exponent <= 10) {
+		float value = (float)mantissa;
+		value = exponent < 0 ? value / powersOfTen[-exponent] : value * powersOfTen[exponent];
+		out = negative ? -value : value;
+		return true;
+	}
 
-	float minX = std::numeric_limits<float>::max();
-	float maxX = std::numeric_limits<float>::min();
-	float minY = std::numeric_limits<float>::max();
-	float maxY = std::numeric_limits<float>::min();
-	float minZ = std::numeric_limits<float>::max();
-	float maxZ = std::numeric_limits<float>::min();
+	// slow path: long mantissas, large exponents, inf/nan
+	char buffer[64];
+	const char* tokenEnd = start;
+	while (tokenEnd < end && !isBlank(*tokenEnd) && *tokenEnd != '\n' && tokenEnd - start < 63) {
+		tokenEnd++;
+	}
+	size_t length = tokenEnd - start;
+	memcpy(buffer, start, length);
+	buffer[length] = '\0';
+
+	char* parsedEnd;
+	out = strtof(buffer, &parsedEnd);
+	if (parsedEnd == buffer) {
+		out = 0.0f;
+		p = start;
+		return false;
+	}
+	p = start + (parsedEnd - buffer);
+	return true;
+}
+
+static bool parseInt(const char* &p, const char* end, unsigned int &out) {
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+')) {
+		negative = (*p == '-');
+		p++;
+	}
+	if (p >= end || *p < '0' || *p > '9') {
+		return false;
+	}
+
+	unsigned int value = 0;
+	while (p < end && *p >= '0' && *p <= '9') {
+		value = value * 10 + (*p - '0');
+		p++;
+	}
+	out = negative ? 0u - value : value;
+	return true;
+}
+
+// Parses one "p/t/n" face corner
+static bool parseFaceVertex(const char* &p, const char* end, unsigned int &position, unsigned int &textureCoord, unsigned int &normal) {
+	skipBlanks(p, end);
+	if (!parseInt(p, end, position)) return false;
+	if (p >= end || *p++ != '/') return false;
+	if (!parseInt(p, end, textureCoord)) return false;
+	if (p >= end || *p++ != '/') return false;
+	return parseInt(p, end, normal);
+}
+
+static inline bool tokenEquals(const char* token, size_t length, const char* literal) {
+	return strlen(literal) == length && memcmp(token, literal, length) == 0;
+}
+
+// Walks a mapped .obj file line by line without copying it
+static void parseObjText(const char* text, size_t size, ObjFileData &data) {
+	const char* p = text;
+	const char* end = text + size;
+
+	while (p < end) {
+		const char* lineEnd = (const char*)memchr(p, '\n', end - p);
+		if (lineEnd == nullptr) {
+			lineEnd = end;
+		}
+
+		skipBlanks(p, lineEnd);
+
+		const char* token = p;
+		while (p < lineEnd && !isBlank(*p)) {
+			p++;
+		}
+		size_t tokenLength = p - token;
+
+		if (tokenEquals(token, tokenLength, "v")) {
+			// a vertex position
+			Vector3 v = { 0.0f, 0.0f, 0.0f };
+			parseFloat(p, lineEnd, v.x);
+			parseFloat(p, lineEnd, v.y);
+			parseFloat(p, lineEnd, v.z);
+			data.vertexPositions.push_back(v);
+		}
+		else if (tokenEquals(token, tokenLength, "vt")) {
+			// a vertex texture coordinate
+			Vector2 t = { 0.0f, 0.0f };
+			parseFloat(p, lineEnd, t.u);
+			parseFloat(p, lineEnd, t.v);
+			data.vertexTextureCoords.push_back(t);
+		}
+		else if (tokenEquals(token, tokenLength, "vn")) {
+			// a vertex normal
+			Vector3 n = { 0.0f, 0.0f, 0.0f };
+			parseFloat(p, lineEnd, n.x);
+			parseFloat(p, lineEnd, n.y);
+			parseFloat(p, lineEnd, n.z);
+			data.vertexNormals.push_back(n);
+		}
+		else if (tokenEquals(token, tokenLength, "f")) {
+			// a face; only triangulated p/t/n faces are supported
+			unsigned int p1, t1, n1, p2, t2, n2, p3, t3, n3;
+			if (parseFaceVertex(p, lineEnd, p1, t1, n1) &&
+				parseFaceVertex(p, lineEnd, p2, t2, n2) &&
+				parseFaceVertex(p, lineEnd, p3, t3, n3)) {
+				data.positionIndices.push_back(p1 - 1);
+				data.positionIndices.push_back(p2 - 1);
+				data.positionIndices.push_back(p3 - 1);
+
+				data.textureCoordIndices.push_back(t1 - 1);
+				data.textureCoordIndices.push_back(t2 - 1);
+				data.textureCoordIndices.push_back(t3 - 1);
+
+				data.normalIndices.push_back(n1 - 1);
+				data.normalIndices.push_back(n2 - 1);
+				data.normalIndices.push_back(n3 - 1);
+			}
+		}
+
+		p = lineEnd + 1;
+	}
+}
+
+static bool parseMapped(const std::string &filename, ObjFileData &data) {
+	MappedFile file;
+	if (!file.open(filename)) {
+		return false;
+	}
+
+	parseObjText(file.getData(), file.getSize(), data);
+	return true;
+}
+
+template <typename T>
+static void appendChunks(std::vector<ObjFileData> &chunks, std::vector<T> ObjFileData::*member, std::vector<T> &out) {
+	// prefix sum of the chunk sizes gives each chunk's offset in the merged array
+	std::vector<size_t> offsets(chunks.size() + 1, 0);
+	for (size_t i = 0; i < chunks.size(); i++) {
+		offsets[i + 1] = offsets[i] + (chunks[i].*member).size();
+	}
+
+	out.resize(offsets[chunks.size()]);
+	ThreadPool::getShared().parallelFor(chunks.size(), [&](unsigned int i) {
+		std::vector<T> &chunk = chunks[i].*member;
+		std::copy(chunk.begin(), chunk.end(), out.begin() + offsets[i]);
+		std::vector<T>().swap(chunk);
+	});
+}
+
+// Splits the mapped file into line-aligned chunks, parses them on the shared thread
+// pool and concatenates the results in file order. Face indices in an .obj are
+// absolute, so the merged arrays are exactly what a single pass would produce.
+static bool parseMappedParallel(const std::string &filename, ObjFileData &data) {
+	MappedFile file;
+	if (!file.open(filename)) {
+		return false;
+	}
+
+	const char* text = file.getData();
+	size_t size = file.getSize();
+
+	ThreadPool &pool = ThreadPool::getShared();
+	if (size < PARALLEL_PARSE_MIN_BYTES || pool.getNumThreads() < 2) {
+		parseObjText(text, size, data);
+		return true;
+	}
+
+	// a few chunks per thread evens out lines of different lengths
+	size_t numChunks = pool.getNumThreads() * 4;
+	size_t chunkSize = size / numChunks + 1;
+
+	std::vector<const char*> boundaries;
+	boundaries.push_back(text);
+	for (size_t i = 1; i < numChunks; i++) {
+		const char* target = text + i * chunkSize;
+		if (target <= boundaries.back()) {
+			continue;
+		}
+		if (target >= text + size) {
+			break;
+		}
+
+		const char* lineEnd = (const char*)memchr(target, '\n', text + size - target);
+		if (lineEnd == nullptr) {
+			break;
+		}
+		boundaries.push_back(lineEnd + 1);
+	}
+	boundaries.push_back(text + size);
+
+	std::vector<ObjFileData> chunks(boundaries.size() - 1);
+	pool.parallelFor(chunks.size(), [&](unsigned int i) {
+		parseObjText(boundaries[i], boundaries[i + 1] - boundaries[i], chunks[i]);
+	});
+
+	appendChunks(chunks, &ObjFileData::vertexPositions, data.vertexPositions);
+	appendChunks(chunks, &ObjFileData::vertexTextureCoords, data.vertexTextureCoords);
+	appendChunks(chunks, &ObjFileData::vertexNormals, data.vertexNormals);
+	appendChunks(chunks, &ObjFileData::positionIndices, data.positionIndices);
+	appendChunks(chunks, &ObjFileData::textureCoordIndices, data.textureCoordIndices);
+	appendChunks(chunks, &ObjFileData::normalIndices, data.normalIndices);
+
+	return true;
+}
+
+static bool parseStream(const std::string &filename, ObjFileData &data) {
+	std::ifstream fileIn(filename);
+
+	if (!fileIn.is_open()) {
+		return false;
+	}
 
 	std::string line;
 	while (getline(fileIn, line)) {
@@ -85,32 +371,7 @@ void ObjMesh::load(const std::string filename, const bool autoCentre = false, co
 				v.y = y;
 				v.z = z;
 
-				// for auto-centering
-				totalX += x;
-				totalY += y;
-				totalZ += z;
-
-				// for auto-normalization
-				if (x < minX) {
-					minX = x;
-				}
-				if (x > maxX) {
-					maxX = x;
-				}
-				if (y < minY) {
-					minY = y;
-				}
-				if (y > maxY) {
-					maxY = y;
-				}
-				if (z < minZ) {
-					minZ = z;
-				}
-				if (z > maxZ) {
-					maxZ = z;
-				}
-
-				vertexPositions.push_back(v);
+				data.vertexPositions.push_back(v);
 			}
 			else if (typeIdentifier == "vt") {
 				// a vertex texture coordinate
@@ -121,7 +382,7 @@ void ObjMesh::load(const std::string filename, const bool autoCentre = false, co
 				t.u = u;
 				t.v = v;
 
-				vertexTextureCoords.push_back(t);
+				data.vertexTextureCoords.push_back(t);
 			}
 			else if (typeIdentifier == "vn") {
 				// a vertex normal
@@ -133,7 +394,7 @@ void ObjMesh::load(const std::string filename, const bool autoCentre = false, co
 				n.y = y;
 				n.z = z;
 
-				vertexNormals.push_back(n);
+				data.vertexNormals.push_back(n);
 			}
 			else if (typeIdentifier == "f") {
 				// a face
@@ -144,23 +405,152 @@ void ObjMesh::load(const std::string filename, const bool autoCentre = false, co
 					&p2, &t2, &n2,
 					&p3, &t3, &n3);
 
-				positionIndices.push_back(p1 - 1);
-				positionIndices.push_back(p2 - 1);
-				positionIndices.push_back(p3 - 1);
-
-				textureCoordIndices.push_back(t1 - 1);
-				textureCoordIndices.push_back(t2 - 1);
-				textureCoordIndices.push_back(t3 - 1);
+				data.positionIndices.push_back(p1 - 1);
+				data.positionIndices.push_back(p2 - 1);
+				data.positionIndices.push_back(p3 - 1);
 
-				normalIndices.push_back(n1 - 1);
-				normalIndices.push_back(n2 - 1);
-				normalIndices.push_back(n3 - 1);
+				data.textureCoordIndices.push_back(t1 - 1);
+				data.textureCoordIndices.push_back(t2 - 1);
+				data.textureCoordIndices.push_back(t3 - 1);
 
-				this->numTriangles++;
+				data.normalIndices.push_back(n1 - 1);
+				data.normalIndices.push_back(n2 - 1);
+				data.normalIndices.push_back(n3 - 1);
 			}
 		}
 	}
-	this->numIndexedVertices = this->numTriangles * 3;
+
+	return true;
+}
+
+ObjMesh::ObjMesh() {
+	this->parser = PARSER_PARALLEL;
+	this->cacheEnabled = false;
+	this->optimizeEnabled = false;
+	this->acmrBefore = 0.0f;
+	this->acmrAfter = 0.0f;
+	this->numVertices = 0;
+	this->numIndexedVertices = 0;
+	this->numTriangles = 0;
+}
+
+void ObjMesh::setParser(Parser parser) {
+	this->parser = parser;
+}
+
+ObjMesh::Parser ObjMesh::getParser() {
+	return this->parser;
+}
+
+void ObjMesh::setCacheEnabled(bool enabled) {
+	this->cacheEnabled = enabled;
+}
+
+bool ObjMesh::getCacheEnabled() {
+	return this->cacheEnabled;
+}
+
+void ObjMesh::setOptimizeEnabled(bool enabled) {
+	this->optimizeEnabled = enabled;
+}
+
+bool ObjMesh::getOptimizeEnabled() {
+	return this->optimizeEnabled;
+}
+
+void ObjMesh::load(const std::string filename, const bool autoCentre = false, const bool autoNormalize = false) {
+	std::cout << "Loading " << filename.c_str() << "..." << std::endl;
+
+	unsigned int cacheFlags = (autoCentre ? MESH_CACHE_AUTO_CENTRE : 0) | (autoNormalize ? MESH_CACHE_AUTO_NORMALIZE : 0) |
+		(this->optimizeEnabled ? MESH_CACHE_OPTIMIZED : 0);
+	std::string cacheFilename = MeshCache::getCacheFilename(filename);
+	this->acmrBefore = 0.0f;
+	this->acmrAfter = 0.0f;
+
+	if (this->cacheEnabled && MeshCache::read(cacheFilename, filename, cacheFlags, *this)) {
+		std::cout << "  read from cache " << cacheFilename << std::endl;
+		return;
+	}
+
+	ObjFileData data;
+	bool loaded;
+	switch (this->parser) {
+	case PARSER_STREAM:
+		loaded = parseStream(filename, data);
+		break;
+	case PARSER_MAPPED:
+		loaded = parseMapped(filename, data);
+		break;
+	default:
+		loaded = parseMappedParallel(filename, data);
+		break;
+	}
+
+	if (!loaded) {
+		return;
+	}
+
+	this->build(data, autoCentre, autoNormalize);
+
+	if (this->optimizeEnabled) {
+		this->optimize();
+	}
+
+	if (this->cacheEnabled && !MeshCache::write(cacheFilename, filename, cacheFlags, *this)) {
+		std::cout << "  could not write cache " << cacheFilename << std::endl;
+	}
+}
+
+void ObjMesh::build(ObjFileData &data, const bool autoCentre, const bool autoNormalize) {
+	std::vector<Vector3> &vertexPositions = data.vertexPositions;
+	std::vector<Vector2> &vertexTextureCoords = data.vertexTextureCoords;
+	std::vector<Vector3> &vertexNormals = data.vertexNormals;
+
+	this->numTriangles = data.positionIndices.size() / 3;
+	this->numVertices = this->numTriangles * 3;
+
+	// for auto-centering
+	float totalX = 0.0f;
+	float totalY = 0.0f;
+	float totalZ = 0.0f;
+
+	float minX = std::numeric_limits<float>::max();
+	float maxX = std::numeric_limits<float>::min();
+	float minY = std::numeric_limits<float>::max();
+	float maxY = std::numeric_limits<float>::min();
+	float minZ = std::numeric_limits<float>::max();
+	float maxZ = std::numeric_limits<float>::min();
+
+	for (unsigned int i = 0; i < vertexPositions.size(); i++) {
+		float x = vertexPositions[i].x;
+		float y = vertexPositions[i].y;
+		float z = vertexPositions[i].z;
+
+		// for auto-centering
+		totalX += x;
+		totalY += y;
+		totalZ += z;
+
+		// for auto-normalization
+		if (x < minX) {
+			minX = x;
+		}
+		if (x > maxX) {
+			maxX = x;
+		}
+		if (y < minY) {
+			minY = y;
+		}
+		if (y > maxY) {
+			maxY = y;
+		}
+		if (z < minZ) {
+			minZ = z;
+		}
+		if (z > maxZ) {
+			maxZ = z;
+		}
+	}
 
 	// for auto-centering
 	this->centre.x = totalX / float(vertexPositions.size());
@@ -200,34 +590,69 @@ void ObjMesh::load(const std::string filename, const bool autoCentre = false, co
 		}
 	}
 
-	// collect the vertex positions, texture coordinates, and normals for each face
+	// weld face corners that share the same position, texture coordinate and normal into
+	// one vertex, so the index buffer references each unique vertex once
 	std::vector<Vector3> indexedPositions;
 	std::vector<Vector2> indexedTextureCoords;
 	std::vector<Vector3> indexedNormals;
 	std::vector<unsigned int> vertexIndices;
+	std::vector<unsigned int> weldedCorners;
+	vertexIndices.reserve(this->numVertices);
 
-	for (unsigned int i = 0; i < this->numIndexedVertices; i++) {
-		unsigned int positionIndex = positionIndices[i];
-		unsigned int textureCoordIndex = textureCoordIndices[i];
-		unsigned int normalIndex = normalIndices[i];
+	unsigned int tableSize = 16;
+	while (tableSize < this->numVertices * 2) {
+		tableSize *= 2;
+	}
+	std::vector<unsigned int> table(tableSize, EMPTY_SLOT);
+
+	for (unsigned int i = 0; i < this->numVertices; i++) {
+		unsigned int positionIndex = data.positionIndices[i];
+		unsigned int textureCoordIndex = data.textureCoordIndices[i];
+		unsigned int normalIndex = data.normalIndices[i];
+
+		// linear probing; every slot holds the corner that first produced a welded vertex
+		unsigned int slot = hashCorner(positionIndex, textureCoordIndex, normalIndex) & (tableSize - 1);
+		while (table[slot] != EMPTY_SLOT) {
+			unsigned int corner = weldedCorners[table[slot]];
+			if (data.positionIndices[corner] == positionIndex &&
+				data.textureCoordIndices[corner] == textureCoordIndex &&
+				data.normalIndices[corner] == normalIndex) {
+				break;
+			}
+			slot = (slot + 1) & (tableSize - 1);
+		}
 
-		indexedPositions.push_back(vertexPositions[positionIndex]);
-		indexedTextureCoords.push_back(vertexTextureCoords[textureCoordIndex]);
-		indexedNormals.push_back(vertexNormals[normalIndex]);
+		if (table[slot] == EMPTY_SLOT) {
+			table[slot] = weldedCorners.size();
+			weldedCorners.push_back(i);
 
-		vertexIndices.push_back(i);
+			indexedPositions.push_back(vertexPositions[positionIndex]);
+			indexedTextureCoords.push_back(vertexTextureCoords[textureCoordIndex]);
+			indexedNormals.push_back(vertexNormals[normalIndex]);
+		}
+
+		vertexIndices.push_back(table[slot]);
 	}
+	this->numIndexedVertices = indexedPositions.size();
 
-	this->indexedPositions = indexedPositions;
-	this->indexedTextureCoords = indexedTextureCoords;
-	this->indexedNormals = indexedNormals;
-	this->triangleIndices = vertexIndices;
+	this->indexedPositions.swap(indexedPositions);
+	this->indexedTextureCoords.swap(indexedTextureCoords);
+	this->indexedNormals.swap(indexedNormals);
+	this->triangleIndices.swap(vertexIndices);
 }
 
 Vector3 ObjMesh::getCentre() {
 	return this->centre;
 }
 
+float ObjMesh::getAcmrBefore() {
+	return this->acmrBefore;
+}
+
+float ObjMesh::getAcmrAfter() {
+	return this->acmrAfter;
+}
+
 Vector3 ObjMesh::getDimensions() {
 	return this->dimensions;
 }
@@ -258,4 +683,50 @@ unsigned int ObjMesh::getNumIndexedVertices() {
 
 unsigned int* ObjMesh::getTriangleIndices() {
 	return this->triangleIndices.data();
-}
\ No newline at end of file
+}
+
+void ObjMesh::optimize() {
+	this->acmrBefore = VertexCacheOptimizer::getAcmr(this->triangleIndices.data(), this->numTriangles, this->numIndexedVertices);
+
+	VertexCacheOptimizer::optimizeTriangleOrder(this->triangleIndices.data(), this->numTriangles, this->numIndexedVertices);
+
+	std::vector<unsigned int> remap;
+	unsigned int numUsed = VertexCacheOptimizer::optimizeVertexOrder(this->triangleIndices.data(), this->numTriangles, this->numIndexedVertices, remap);
+
+	std::vector<Vector3> positions(numUsed);
+	std::vector<Vector3> normals(numUsed);
+	std::vector<Vector2> textureCoords(numUsed);
+	for (unsigned int i = 0; i < this->numIndexedVertices; i++) {
+		if (remap[i] < numUsed) {
+			positions[remap[i]] = this->indexedPositions[i];
+			normals[remap[i]] = this->indexedNormals[i];
+			textureCoords[remap[i]] = this->indexedTextureCoords[i];
+		}
+	}
+	this->indexedPositions.swap(positions);
+	this->indexedNormals.swap(normals);
+	this->indexedTextureCoords.swap(textureCoords);
+	this->numIndexedVertices = numUsed;
+
+	this->acmrAfter = VertexCacheOptimizer::getAcmr(this->triangleIndices.data(), this->numTriangles, this->numIndexedVertices);
+}
+
+void ObjMesh::getVertices(std::vector<Vertex> &vertices) {
+	vertices.resize(this->numIndexedVertices);
+	for (unsigned int i = 0; i < this->numIndexedVertices; i++) {
+		vertices[i].position = this->indexedPositions[i];
+		vertices[i].normal = this->indexedNormals[i];
+		vertices[i].textureCoord = this->indexedTextureCoords[i];
+	}
+}
+
+void ObjMesh::getPackedVertices(std::vector<PackedVertex> &vertices) {
+	vertices.resize(this->numIndexedVertices);
+	for (unsigned int i = 0; i < this->numIndexedVertices; i++) {
+		Vertex vertex;
+		vertex.position = this->indexedPositions[i];
+		vertex.normal = this->indexedNormals[i];
+		vertex.textureCoord = this->indexedTextureCoords[i];
+		vertices[i] = packVertex(vertex);
+	}
+}
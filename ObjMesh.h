@@ -3,19 +3,28 @@
 
 #pragma once
 
-struct Vector3 {
-	float x;
-	float y;
-	float z;
-};
+#include "VertexFormat.h"
 
-struct Vector2 {
-	float u;
-	float v;
-};
+struct ObjFileData;
 
 class ObjMesh {
+public:
+	// How the .obj text is read. PARSER_STREAM is the original getline/stringstream
+	// reader, PARSER_MAPPED maps the file and tokenizes it in place, and
+	// PARSER_PARALLEL does the same on the shared thread pool for large files.
+	// All of them produce identical output.
+	enum Parser {
+		PARSER_STREAM,
+		PARSER_MAPPED,
+		PARSER_PARALLEL
+	};
+
 private:
+	friend class MeshCache;
+
+	Parser parser;
+	bool cacheEnabled;
+	bool optimizeEnabled;
 	unsigned int numVertices;
 	unsigned int numTriangles;
 	unsigned int numIndexedVertices;
@@ -25,22 +34,52 @@ private:
 	std::vector<Vector3> indexedNormals;
 	Vector3 centre;
 	Vector3 dimensions;
+	float acmrBefore;
+	float acmrAfter;
+
+	void build(ObjFileData &data, const bool autoCentre, const bool autoNormalize);
 
 public:
 	ObjMesh();
-	
+
+	void setParser(Parser parser);
+	Parser getParser();
+
+	// When enabled, load() reads a binary cache next to the .obj if it is up to
+	// date, and writes one after parsing otherwise. See MeshCache.h.
+	void setCacheEnabled(bool enabled);
+	bool getCacheEnabled();
+
+	// When enabled, load() runs optimize() on the mesh (and caches it optimized)
+	void setOptimizeEnabled(bool enabled);
+	bool getOptimizeEnabled();
+
 	void load(const std::string filename, const bool autoCentre, const bool autoNormalize);
 
+	// Reorders the triangles for the post-transform vertex cache and then the vertices
+	// in the order the triangles use them (see VertexCacheOptimizer.h)
+	void optimize();
+
 	Vector3* getIndexedPositions();
 	Vector2* getIndexedTextureCoords();
 	Vector3* getIndexedNormals();
 
+	// number of face corners in the file (numTriangles * 3), before welding
 	unsigned int getNumVertices();
+	// number of unique vertices after welding; the size of the indexed arrays
 	unsigned int getNumIndexedVertices();
 	unsigned int getNumTriangles();
 
 	unsigned int* getTriangleIndices();
 
+	// the indexed arrays interleaved into one buffer per vertex
+	void getVertices(std::vector<Vertex> &vertices);
+	void getPackedVertices(std::vector<PackedVertex> &vertices);
+
 	Vector3 getCentre();
 	Vector3 getDimensions();
+
+	// average cache miss ratio of the index order before and after optimize(), 0 if it has not run
+	float getAcmrBefore();
+	float getAcmrAfter();
 };
@@ -0,0 +1,136 @@
+#include "ProceduralMesh.h"
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <fstream>
+
+void ProceduralMesh::addLathe(const std::vector<LathePoint> &outline, unsigned int numSegments) {
+	unsigned int numColumns = numSegments + 1;
+	unsigned int numRows = outline.size();
+	unsigned int firstVertex = this->positions.size();
+
+	// one sin/cos per column rather than per vertex; the inner loop is then only multiplies
+	std::vector<float> cosTheta(numColumns);
+	std::vector<float> sinTheta(numColumns);
+	for (unsigned int i = 0; i < numColumns; i++) {
+		double theta = (M_PI * 2.0) * i / numSegments;
+		cosTheta[i] = (float)cos(theta);
+		sinTheta[i] = (float)sin(theta);
+	}
+	// exact seam, so the first and last columns weld in position
+	cosTheta[numSegments] = cosTheta[0];
+	sinTheta[numSegments] = sinTheta[0];
+
+	this->positions.resize(firstVertex + numRows * numColumns);
+	this->normals.resize(firstVertex + numRows * numColumns);
+	this->textureCoords.resize(firstVertex + numRows * numColumns);
+
+	glm::vec3* position = &this->positions[firstVertex];
+	glm::vec3* normal = &this->normals[firstVertex];
+	glm::vec2* textureCoord = &this->textureCoords[firstVertex];
+
+	for (unsigned int j = 0; j < numRows; j++) {
+		const LathePoint &point = outline[j];
+
+		for (unsigned int i = 0; i < numColumns; i++) {
+			position->x = point.radius * cosTheta[i];
+			position->y = point.y;
+			position->z = point.radius * sinTheta[i];
+			normal->x = point.normalRadius * cosTheta[i];
+			normal->y = point.normalY;
+			normal->z = point.normalRadius * sinTheta[i];
+			textureCoord->x = (float)i / numSegments;
+			textureCoord->y = point.v;
+
+			position++;
+			normal++;
+			textureCoord++;
+		}
+	}
+
+	// with u going round and v along the outline, (i, j), (i, j + 1), (i + 1, j) faces outward
+	unsigned int firstIndex = this->triangleIndices.size();
+	this->triangleIndices.resize(firstIndex + (numRows - 1) * numSegments * 6);
+	unsigned int* index = &this->triangleIndices[firstIndex];
+
+	for (unsigned int j = 0; j + 1 < numRows; j++) {
+		bool bottomOnAxis = outline[j].radius == 0.0f;
+		bool topOnAxis = outline[j + 1].radius == 0.0f;
+		unsigned int row = firstVertex + j * numColumns;
+
+		for (unsigned int i = 0; i < numSegments; i++) {
+			unsigned int a = row + i;
+			unsigned int b = a + 1;
+			unsigned int c = a + numColumns;
+			unsigned int d = c + 1;
+
+			if (!bottomOnAxis) {
+				index[0] = a;
+				index[1] = c;
+				index[2] = b;
+				index += 3;
+			}
+			if (!topOnAxis) {
+				index[0] = b;
+				index[1] = c;
+				index[2] = d;
+				index += 3;
+			}
+		}
+	}
+
+	this->triangleIndices.resize(index - this->triangleIndices.data());
+}
+
+void ProceduralMesh::addQuad(const glm::vec3 centre, const glm::vec3 axisU, const glm::vec3 axisV, const glm::vec3 normal) {
+	unsigned int firstVertex = this->positions.size();
+
+	const float corners[4][2] = { { -1.0f, -1.0f }, { 1.0f, -1.0f }, { 1.0f, 1.0f }, { -1.0f, 1.0f } };
+	for (int i = 0; i < 4; i++) {
+		this->positions.push_back(centre + axisU * corners[i][0] + axisV * corners[i][1]);
+		this->normals.push_back(normal);
+		this->textureCoords.push_back(glm::vec2((corners[i][0] + 1.0f) * 0.5f, (corners[i][1] + 1.0f) * 0.5f));
+	}
+
+	const unsigned int quadIndices[6] = { 0, 1, 2, 0, 2, 3 };
+	for (int i = 0; i < 6; i++) {
+		this->triangleIndices.push_back(firstVertex + quadIndices[i]);
+	}
+}
+
+void ProceduralMesh::save(const std::string filename) {
+	std::cout << "Saving geometry to " << filename << std::endl;
+
+	std::ofstream fileOut(filename.c_str());
+
+	if (!fileOut.is_open()) {
+		return;
+	}
+
+	for (unsigned int i = 0; i < positions.size(); i++) {
+		fileOut << "v " << positions[i].x << " " << positions[i].y << " " << positions[i].z << std::endl;
+	}
+
+	for (unsigned int i = 0; i < textureCoords.size(); i++) {
+		fileOut << "vt " << textureCoords[i].s << " " << textureCoords[i].t << std::endl;
+	}
+
+	for (unsigned int i = 0; i < normals.size(); i++) {
+		fileOut << "vn " << normals[i].x << " " << normals[i].y << " " << normals[i].z << std::endl;
+	}
+
+	for (unsigned int i = 0; i < triangleIndices.size(); i += 3) {
+		fileOut << "f " << triangleIndices[i] + 1 << "/" << triangleIndices[i] + 1 << "/" << triangleIndices[i] + 1 << " ";
+		fileOut << triangleIndices[i + 1] + 1 << "/" << triangleIndices[i + 1] + 1 << "/" << triangleIndices[i + 1] + 1 << " ";
+		fileOut << triangleIndices[i + 2] + 1 << "/" << triangleIndices[i + 2] + 1 << "/" << triangleIndices[i + 2] + 1 << std::endl;
+	}
+
+	fileOut.close();
+}
+
+glm::vec3* ProceduralMesh::getPositions() { return this->positions.data(); }
+glm::vec2* ProceduralMesh::getTextureCoords() { return this->textureCoords.data(); }
+glm::vec3* ProceduralMesh::getNormals() { return this->normals.data(); }
+unsigned int ProceduralMesh::getNumVertices() { return this->positions.size(); }
+unsigned int ProceduralMesh::getNumTriangles() { return this->triangleIndices.size() / 3; }
+unsigned int* ProceduralMesh::getTriangleIndices() { return this->triangleIndices.data(); }
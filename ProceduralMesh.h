@@ -0,0 +1,51 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Point on the outline of a surface of revolution, in the (radius, y) half plane.
+// v is the texture coordinate along the outline.
+struct LathePoint {
+	float radius;
+	float y;
+	float normalRadius;
+	float normalY;
+	float v;
+};
+
+// Base for meshes generated in memory rather than loaded: welded, indexed positions,
+// normals and uvs ready for createGeometry. Subclasses build their arrays in their
+// constructor; save() only exports them as an .obj.
+//
+// Shapes are y-up and centred on the origin, with counter-clockwise front faces.
+class ProceduralMesh {
+protected:
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec2> textureCoords;
+	std::vector<glm::vec3> normals;
+	std::vector<unsigned int> triangleIndices;
+
+	// Sweeps the outline once around the y axis in numSegments steps. The seam is
+	// duplicated so u runs from 0 to 1, and triangles that would collapse where the
+	// outline touches the axis are left out.
+	void addLathe(const std::vector<LathePoint> &outline, unsigned int numSegments);
+
+	// One flat quad facing normal, spanning -1..1 along axisU and axisV (normal = axisU x axisV)
+	void addQuad(const glm::vec3 centre, const glm::vec3 axisU, const glm::vec3 axisV, const glm::vec3 normal);
+
+public:
+	virtual ~ProceduralMesh() {}
+
+	glm::vec3* getPositions();
+	glm::vec2* getTextureCoords();
+	glm::vec3* getNormals();
+
+	unsigned int getNumVertices();
+	unsigned int getNumTriangles();
+
+	unsigned int* getTriangleIndices();
+
+	void save(const std::string filename);
+};
@@ -0,0 +1,204 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstring>
+
+static const char* phaseNames[PROFILE_NUM_PHASES] = { "update", "animation", "transforms", "draw", "gpu" };
+
+Profiler::Profiler() {
+	this->frame = 0;
+	this->gpuTiming = false;
+	this->queryActive = false;
+	this->numRecorded = 0;
+
+	memset(this->milliseconds, 0, sizeof(this->milliseconds));
+	memset(this->queries, 0, sizeof(this->queries));
+	memset(this->pending, 0, sizeof(this->pending));
+
+	for (int i = 0; i < PROFILE_NUM_PHASES; i++) {
+		this->history[i].resize(HISTORY_FRAMES);
+	}
+}
+
+void Profiler::init(bool gpuTiming) {
+	this->gpuTiming = gpuTiming;
+	if (gpuTiming) {
+		glGenQueries(QUERY_RING_SIZE, this->queries);
+	}
+}
+
+void Profiler::close() {
+	// oldest first, so the trace stays in frame order
+	for (unsigned int i = 1; i <= QUERY_RING_SIZE; i++) {
+		PendingFrame &pendingFrame = this->pending[(this->frame + i) % QUERY_RING_SIZE];
+		if (pendingFrame.waiting) {
+			this->record(pendingFrame);
+		}
+	}
+
+	// gpuTiming stays set so print() still reports the GPU times
+	if (this->queries[0] != 0) {
+		glDeleteQueries(QUERY_RING_SIZE, this->queries);
+		memset(this->queries, 0, sizeof(this->queries));
+	}
+
+	this->closeCsv();
+}
+
+void Profiler::closeCsv() {
+	if (this->csv.is_open()) {
+		this->csv.close();
+	}
+}
+
+bool Profiler::openCsv(const std::string filename) {
+	this->csv.open(filename.c_str(), std::ios::trunc);
+	if (!this->csv.is_open()) {
+		return false;
+	}
+
+	this->csv << "frame";
+	for (int i = 0; i < PROFILE_NUM_PHASES; i++) {
+		this->csv << "," << phaseNames[i] << "_ms";
+	}
+	this->csv << "\n";
+	return true;
+}
+
+void Profiler::begin(ProfilePhase phase) {
+	this->phaseStart[phase] = Clock::now();
+}
+
+void Profiler::end(ProfilePhase phase) {
+	this->milliseconds[phase] += std::chrono::duration<double, std::milli>(Clock::now() - this->phaseStart[phase]).count();
+}
+
+void Profiler::beginGpu() {
+	if (this->queries[0] == 0) {
+		return;
+	}
+
+	// the slot is reused every QUERY_RING_SIZE frames; if its result still has not
+	// come back, wait for it rather than lose the frame
+	PendingFrame &pendingFrame = this->pending[this->frame % QUERY_RING_SIZE];
+	if (pendingFrame.waiting) {
+		this->record(pendingFrame);
+	}
+
+	glBeginQuery(GL_TIME_ELAPSED, this->queries[this->frame % QUERY_RING_SIZE]);
+	this->queryActive = true;
+}
+
+void Profiler::endGpu() {
+	if (this->queryActive) {
+		glEndQuery(GL_TIME_ELAPSED);
+		this->queryActive = false;
+		this->pending[this->frame % QUERY_RING_SIZE].queryIssued = true;
+	}
+}
+
+void Profiler::endFrame() {
+	unsigned int slot = this->frame % QUERY_RING_SIZE;
+	PendingFrame &pendingFrame = this->pending[slot];
+	if (pendingFrame.waiting) {
+		this->record(pendingFrame);
+	}
+
+	pendingFrame.frame = this->frame;
+	memcpy(pendingFrame.milliseconds, this->milliseconds, sizeof(this->milliseconds));
+	pendingFrame.waiting = true;
+	memset(this->milliseconds, 0, sizeof(this->milliseconds));
+
+	// record whatever the GPU has finished with, oldest first, stopping at the first
+	// frame still in flight so the trace stays in order
+	for (unsigned int i = 1; i <= QUERY_RING_SIZE; i++) {
+		PendingFrame &oldest = this->pending[(slot + i) % QUERY_RING_SIZE];
+		if (!oldest.waiting) {
+			continue;
+		}
+
+		if (oldest.queryIssued) {
+			GLuint available = GL_FALSE;
+			glGetQueryObjectuiv(this->queries[oldest.frame % QUERY_RING_SIZE], GL_QUERY_RESULT_AVAILABLE, &available);
+			if (!available) {
+				break;
+			}
+		}
+
+		this->record(oldest);
+	}
+
+	this->frame++;
+}
+
+void Profiler::record(PendingFrame &pendingFrame) {
+	if (pendingFrame.queryIssued) {
+		// blocks if the result is not ready yet
+		GLuint64 elapsedNs = 0;
+		glGetQueryObjectui64v(this->queries[pendingFrame.frame % QUERY_RING_SIZE], GL_QUERY_RESULT, &elapsedNs);
+		pendingFrame.milliseconds[PROFILE_GPU] = elapsedNs / 1e6;
+	}
+
+	pendingFrame.waiting = false;
+	pendingFrame.queryIssued = false;
+
+	if (pendingFrame.frame < WARM_UP_FRAMES) {
+		return;
+	}
+
+	unsigned int index = this->numRecorded % HISTORY_FRAMES;
+	for (int i = 0; i < PROFILE_NUM_PHASES; i++) {
+		this->history[i][index] = pendingFrame.milliseconds[i];
+	}
+	this->numRecorded++;
+
+	if (this->csv.is_open()) {
+		this->csv << pendingFrame.frame;
+		for (int i = 0; i < PROFILE_NUM_PHASES; i++) {
+			this->csv << "," << pendingFrame.milliseconds[i];
+		}
+		this->csv << "\n";
+	}
+}
+
+unsigned long long Profiler::getNumRecorded() {
+	return this->numRecorded;
+}
+
+void Profiler::getStats(ProfilePhase phase, double &min, double &avg, double &p99) {
+	size_t count = (size_t)std::min<unsigned long long>(this->numRecorded, HISTORY_FRAMES);
+	if (count == 0) {
+		min = avg = p99 = 0.0;
+		return;
+	}
+
+	std::vector<double> samples(this->history[phase].begin(), this->history[phase].begin() + count);
+
+	min = *std::min_element(samples.begin(), samples.end());
+
+	double total = 0.0;
+	for (double sample : samples) {
+		total += sample;
+	}
+	avg = total / count;
+
+	// nearest rank
+	size_t rank = (size_t)((count * 99 + 99) / 100) - 1;
+	std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+	p99 = samples[rank];
+}
+
+void Profiler::print(std::ostream &out) {
+	size_t count = (size_t)std::min<unsigned long long>(this->numRecorded, HISTORY_FRAMES);
+	out << "Frame times over the last " << count << " frames (ms, min/avg/p99):" << std::endl;
+
+	for (int i = 0; i < PROFILE_NUM_PHASES; i++) {
+		if (i == PROFILE_GPU && !this->gpuTiming) {
+			continue;
+		}
+
+		double min, avg, p99;
+		this->getStats((ProfilePhase)i, min, avg, p99);
+		out << "  " << phaseNames[i] << ": " << min << " / " << avg << " / " << p99 << std::endl;
+	}
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <chrono>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+// Phases timed each frame. Animation runs inside update, so it is also counted there.
+enum ProfilePhase {
+	PROFILE_UPDATE,
+	PROFILE_ANIMATION,
+	PROFILE_TRANSFORMS,
+	PROFILE_DRAW,
+	PROFILE_GPU, // measured with GL_TIME_ELAPSED queries, not begin()/end()
+	PROFILE_NUM_PHASES
+};
+
+// Per-frame CPU and GPU timings with rolling statistics over the last HISTORY_FRAMES
+// frames, and an optional CSV trace of every frame.
+//
+// The first WARM_UP_FRAMES frames are left out: they include shader compilation and
+// first-use driver work, and some drivers (e.g. llvmpipe) report a bogus GPU time for them.
+//
+// GPU times arrive a few frames late, so each frame is held in a small ring until its
+// query result is available; only then is it added to the statistics and the trace.
+class Profiler {
+public:
+	static const unsigned int HISTORY_FRAMES = 600;
+	static const unsigned int QUERY_RING_SIZE = 4;
+	static const unsigned int WARM_UP_FRAMES = 2;
+
+private:
+	typedef std::chrono::high_resolution_clock Clock;
+
+	struct PendingFrame {
+		unsigned long long frame;
+		double milliseconds[PROFILE_NUM_PHASES];
+		bool waiting;
+		bool queryIssued;
+	};
+
+	unsigned long long frame;
+	Clock::time_point phaseStart[PROFILE_NUM_PHASES];
+	double milliseconds[PROFILE_NUM_PHASES];
+
+	bool gpuTiming;
+	GLuint queries[QUERY_RING_SIZE];
+	PendingFrame pending[QUERY_RING_SIZE];
+	bool queryActive;
+
+	// history[phase] is a ring of HISTORY_FRAMES, filled up to numRecorded
+	std::vector<double> history[PROFILE_NUM_PHASES];
+	unsigned long long numRecorded;
+
+	std::ofstream csv;
+
+	void record(PendingFrame &pendingFrame);
+
+public:
+	Profiler();
+
+	// Creates the timer queries; needs a current GL context
+	void init(bool gpuTiming);
+	// Resolves the frames still waiting for the GPU, frees the queries and closes the
+	// CSV trace; calling it again does nothing
+	void close();
+	// Closes the CSV trace without the frames still waiting for the GPU. It makes no GL
+	// calls, so unlike close() it is safe once the context is gone.
+	void closeCsv();
+
+	bool openCsv(const std::string filename);
+
+	void begin(ProfilePhase phase);
+	void end(ProfilePhase phase);
+
+	// Bracket the GL commands of a frame
+	void beginGpu();
+	void endGpu();
+
+	void endFrame();
+
+	unsigned long long getNumRecorded();
+	void getStats(ProfilePhase phase, double &min, double &avg, double &p99);
+	void print(std::ostream &out);
+};
@@ -30,9 +30,72 @@ GLuint ShaderProgram::loadShaders(const std::string vertexShaderFilename, const
 	glDeleteShader(this->vertexShaderId);
 	glDeleteShader(this->fragmentShaderId);
 
+	this->cacheLocations();
+
 	return this->programId;
 }
 
+void ShaderProgram::cacheLocations() {
+	this->uniformLocations.clear();
+	this->attribLocations.clear();
+
+	GLint linked = GL_FALSE;
+	glGetProgramiv(this->programId, GL_LINK_STATUS, &linked);
+	if (linked == GL_FALSE) {
+		return;
+	}
+
+	GLint maxNameLength = 0;
+	glGetProgramiv(this->programId, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+	GLint maxAttribNameLength = 0;
+	glGetProgramiv(this->programId, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxAttribNameLength);
+	if (maxAttribNameLength > maxNameLength) {
+		maxNameLength = maxAttribNameLength;
+	}
+	std::string name(maxNameLength + 1, '\0');
+
+	GLint numUniforms = 0;
+	glGetProgramiv(this->programId, GL_ACTIVE_UNIFORMS, &numUniforms);
+	for (GLint i = 0; i < numUniforms; i++) {
+		GLsizei length = 0;
+		GLint size;
+		GLenum type;
+		glGetActiveUniform(this->programId, i, name.size(), &length, &size, &type, &name[0]);
+
+		std::string uniformName(name.c_str(), length);
+		GLint location = glGetUniformLocation(this->programId, uniformName.c_str());
+		this->uniformLocations[uniformName] = location;
+
+		// arrays are reported as "name[0]"; allow looking them up by the bare name too
+		size_t bracket = uniformName.find('[');
+		if (bracket != std::string::npos) {
+			this->uniformLocations[uniformName.substr(0, bracket)] = location;
+		}
+	}
+
+	GLint numAttribs = 0;
+	glGetProgramiv(this->programId, GL_ACTIVE_ATTRIBUTES, &numAttribs);
+	for (GLint i = 0; i < numAttribs; i++) {
+		GLsizei length = 0;
+		GLint size;
+		GLenum type;
+		glGetActiveAttrib(this->programId, i, name.size(), &length, &size, &type, &name[0]);
+
+		std::string attribName(name.c_str(), length);
+		this->attribLocations[attribName] = glGetAttribLocation(this->programId, attribName.c_str());
+	}
+}
+
+GLint ShaderProgram::getUniformLocation(const std::string name) {
+	std::map<std::string, GLint>::iterator it = this->uniformLocations.find(name);
+	return it == this->uniformLocations.end() ? -1 : it->second;
+}
+
+GLint ShaderProgram::getAttribLocation(const std::string name) {
+	std::map<std::string, GLint>::iterator it = this->attribLocations.find(name);
+	return it == this->attribLocations.end() ? -1 : it->second;
+}
+
 GLuint ShaderProgram::loadShader(const GLenum shaderType, const std::string shaderFilename) {
 	// load the contents of the specified text file
 	std::ifstream fileIn(shaderFilename);
@@ -1,6 +1,7 @@
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <map>
 
 #include <GL/glew.h>
 
@@ -13,7 +14,12 @@ private:
 	GLuint fragmentShaderId;
 	GLuint programId;
 
+	// active uniform and attribute locations, looked up once after linking
+	std::map<std::string, GLint> uniformLocations;
+	std::map<std::string, GLint> attribLocations;
+
 	GLuint loadShader(const GLenum shaderType, const std::string shaderFilename);
+	void cacheLocations();
 
 public:
 	ShaderProgram();
@@ -23,4 +29,8 @@ public:
 	GLuint getVertexShaderId();
 	GLuint getFragmentShaderId();
 	GLuint getProgramId();
+
+	// -1 if the program has no active uniform/attribute of that name
+	GLint getUniformLocation(const std::string name);
+	GLint getAttribLocation(const std::string name);
 };
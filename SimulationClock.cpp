@@ -0,0 +1,47 @@
+#include "SimulationClock.h"
+
+SimulationClock::SimulationClock(unsigned int stepMs) : stepMs(stepMs) {
+	this->timeMs = 0;
+	this->accumulatorMs = 0.0;
+	this->timeScale = 1.0;
+	this->maxStepsPerAdvance = 100000;
+	this->paused = false;
+}
+
+void SimulationClock::advance(double realMs) {
+	if (this->paused || realMs <= 0.0) {
+		return;
+	}
+
+	this->accumulatorMs += realMs * this->timeScale;
+
+	double maxAccumulatedMs = (double)this->maxStepsPerAdvance * this->stepMs;
+	if (this->accumulatorMs > maxAccumulatedMs) {
+		this->accumulatorMs = maxAccumulatedMs;
+	}
+}
+
+bool SimulationClock::step() {
+	if (this->accumulatorMs < this->stepMs) {
+		return false;
+	}
+
+	this->accumulatorMs -= this->stepMs;
+	this->timeMs += this->stepMs;
+	return true;
+}
+
+float SimulationClock::getAlpha() {
+	return (float)(this->accumulatorMs / this->stepMs);
+}
+
+unsigned long long SimulationClock::getTimeMs() { return this->timeMs; }
+unsigned int SimulationClock::getStepMs() { return this->stepMs; }
+
+void SimulationClock::setTimeScale(double timeScale) { this->timeScale = timeScale > 0.0 ? timeScale : 0.0; }
+double SimulationClock::getTimeScale() { return this->timeScale; }
+
+void SimulationClock::setMaxStepsPerAdvance(unsigned int maxSteps) { this->maxStepsPerAdvance = maxSteps; }
+
+void SimulationClock::setPaused(bool paused) { this->paused = paused; }
+bool SimulationClock::isPaused() { return this->paused; }
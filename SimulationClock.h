@@ -0,0 +1,45 @@
+#pragma once
+
+// Fixed timestep clock for the simulation. Real time is fed in with advance(), scaled,
+// and handed back as whole steps of getStepMs() simulated milliseconds:
+//
+//   clock.advance(realDeltaMs);
+//   while (clock.step()) simulate(clock.getTimeMs());
+//   render(clock.getAlpha());
+//
+// Nothing here reads a system clock, so a run can be reproduced by feeding it the
+// same deltas (or none at all, by calling advance() by hand).
+class SimulationClock {
+private:
+	unsigned int stepMs;
+	unsigned long long timeMs;
+	double accumulatorMs;
+	double timeScale;
+	unsigned int maxStepsPerAdvance;
+	bool paused;
+
+public:
+	SimulationClock(unsigned int stepMs = 10);
+
+	// Queues realMs * timeScale of simulation time. When more than maxStepsPerAdvance
+	// steps would be due the rest is dropped, so a stall slows the simulation down
+	// rather than making it skip ahead.
+	void advance(double realMs);
+
+	// Consumes one step if one is due, moving getTimeMs() on by getStepMs()
+	bool step();
+
+	// How far (0 to 1) the leftover time is into the next step, to blend the last two states
+	float getAlpha();
+
+	unsigned long long getTimeMs();
+	unsigned int getStepMs();
+
+	void setTimeScale(double timeScale);
+	double getTimeScale();
+
+	void setMaxStepsPerAdvance(unsigned int maxSteps);
+
+	void setPaused(bool paused);
+	bool isPaused();
+};
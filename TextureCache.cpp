@@ -0,0 +1,345 @@
+#include "TextureCache.h"
+#include "MappedFile.h"
+
+#include <iostream>
+
+#include "apis/stb_image.h"
+
+// 64-bit FNV-1a, the same hash MappedFile::hashFile uses for files
+static unsigned long long hashBytes(const unsigned char* data, size_t size) {
+	unsigned long long hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= data[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+TextureCache::TextureCache() {
+	this->gpuBytes = 0;
+}
+
+GLuint TextureCache::find(const Key &key) {
+	std::map<Key, GLuint>::iterator found = this->textures.find(key);
+	if (found == this->textures.end()) {
+		return 0;
+	}
+
+	this->entries[found->second].references++;
+	return found->second;
+}
+
+void TextureCache::insert(const Key &key, GLuint texture, int width, int height, size_t bytes) {
+	Entry entry;
+	entry.key = key;
+	entry.width = width;
+	entry.height = height;
+	entry.bytes = bytes;
+	entry.references = 1;
+
+	this->textures[key] = texture;
+	this->entries[texture] = entry;
+	this->gpuBytes += entry.bytes;
+}
+
+GLuint TextureCache::create(GLenum target) {
+	GLuint texture;
+	glGenTextures(1, &texture);
+	glBindTexture(target, texture);
+
+	// resizing settings
+	glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+
+	// faces are not meant to wrap into themselves at their edges
+	if (target == GL_TEXTURE_CUBE_MAP) {
+		glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(target, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	}
+
+	return texture;
+}
+
+bool TextureCache::getCubemapLevels(const CubemapImage &image, GLenum &compressedFormat, std::vector<StreamLevel> &levels) {
+	levels.clear();
+
+	if (!image.compressedFaces.empty()) {
+		const CompressedImage &first = image.compressedFaces[0];
+		for (const CompressedImage &face : image.compressedFaces) {
+			if (face.format != first.format || face.levels.size() != first.levels.size()) {
+				return false;
+			}
+		}
+		compressedFormat = first.format == TEXTURE_FORMAT_DXT1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+
+		levels.resize(first.levels.size());
+		for (unsigned int l = 0; l < levels.size(); l++) {
+			levels[l].width = first.levels[l].width;
+			levels[l].height = first.levels[l].height;
+			for (const CompressedImage &face : image.compressedFaces) {
+				levels[l].data.insert(levels[l].data.end(), face.levels[l].data.begin(), face.levels[l].data.end());
+			}
+		}
+		return true;
+	}
+
+	if (image.faces.size() != CUBEMAP_FACES || image.mips.size() != CUBEMAP_FACES) {
+		return false;
+	}
+	compressedFormat = 0;
+
+	levels.resize(image.mips[0].size() + 1);
+	for (unsigned int l = 0; l < levels.size(); l++) {
+		for (unsigned int f = 0; f < CUBEMAP_FACES; f++) {
+			const MipLevel &level = l == 0 ? image.faces[f] : image.mips[f][l - 1];
+			levels[l].width = level.width;
+			levels[l].height = level.height;
+			levels[l].data.insert(levels[l].data.end(), level.pixels.begin(), level.pixels.end());
+		}
+	}
+	return true;
+}
+
+GLuint TextureCache::acquire(const std::string filename) {
+	unsigned long long hash = MappedFile::hashFile(filename);
+	GLuint texture = this->find(Key(filename, hash));
+	if (texture != 0) {
+		return texture;
+	}
+
+	int width, height, numComponents;
+	unsigned char* pixels = stbi_load(filename.c_str(), &width, &height, &numComponents, 4);
+	if (pixels == nullptr) {
+		std::cerr << "Could not load texture " << filename << ": " << stbi_failure_reason() << std::endl;
+		return 0;
+	}
+
+	texture = this->acquire(filename, hash, pixels, width, height);
+	stbi_image_free(pixels);
+	return texture;
+}
+
+GLuint TextureCache::acquire(const std::string name, unsigned long long hash, const unsigned char* pixels, int width, int height) {
+	if (pixels == nullptr || this->textures.count(Key(name, hash)) > 0) {
+		return this->acquire(name, hash, pixels, width, height, std::vector<MipLevel>());
+	}
+
+	std::vector<MipLevel> mips;
+	MipmapGenerator::generate(pixels, width, height, MIPMAP_FILTER_KAISER, true, mips);
+	return this->acquire(name, hash, pixels, width, height, mips);
+}
+
+GLuint TextureCache::acquire(const std::string name, unsigned long long hash, const unsigned char* pixels, int width, int height, const std::vector<MipLevel> &mips) {
+	Key key(name, hash);
+	GLuint texture = this->find(key);
+	if (texture != 0 || pixels == nullptr) {
+		return texture;
+	}
+
+	texture = create(GL_TEXTURE_2D);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mips.size());
+
+	// provide the image data to OpenGL, the mip chain ready made
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+	for (unsigned int l = 0; l < mips.size(); l++) {
+		glTexImage2D(GL_TEXTURE_2D, l + 1, GL_RGBA8, mips[l].width, mips[l].height, 0, GL_RGBA, GL_UNSIGNED_BYTE, mips[l].pixels.data());
+	}
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	size_t bytes = (size_t)width * height * 4;
+	for (const MipLevel &mip : mips) {
+		bytes += mip.pixels.size();
+	}
+	this->insert(key, texture, width, height, bytes);
+
+	return texture;
+}
+
+GLuint TextureCache::acquire(const std::string name, unsigned long long hash, const CompressedImage &image) {
+	Key key(name, hash);
+	GLuint texture = this->find(key);
+	if (texture != 0 || image.levels.empty() || !isCompressionSupported()) {
+		return texture;
+	}
+
+	GLenum format = image.format == TEXTURE_FORMAT_DXT1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+
+	texture = create(GL_TEXTURE_2D);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, image.levels.size() - 1);
+
+	// the mip chain comes compressed already, so there is nothing to generate
+	for (unsigned int l = 0; l < image.levels.size(); l++) {
+		const CompressedLevel &level = image.levels[l];
+		glCompressedTexImage2D(GL_TEXTURE_2D, l, format, level.width, level.height, 0, level.data.size(), level.data.data());
+	}
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	this->insert(key, texture, image.width, image.height, image.getSize());
+
+	return texture;
+}
+
+GLuint TextureCache::acquire(const std::string name, unsigned long long hash, const CubemapImage &image) {
+	Key key(name, hash);
+	GLuint texture = this->find(key);
+	GLenum compressedFormat;
+	std::vector<StreamLevel> levels;
+	if (texture != 0 || !getCubemapLevels(image, compressedFormat, levels) || (compressedFormat != 0 && !isCompressionSupported())) {
+		return texture;
+	}
+
+	texture = create(GL_TEXTURE_CUBE_MAP);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, levels.size() - 1);
+
+	for (unsigned int l = 0; l < levels.size(); l++) {
+		const StreamLevel &level = levels[l];
+		size_t faceBytes = level.data.size() / CUBEMAP_FACES;
+		for (unsigned int f = 0; f < CUBEMAP_FACES; f++) {
+			if (compressedFormat == 0) {
+				glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + f, l, GL_RGBA8, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, &level.data[faceBytes * f]);
+			}
+			else {
+				glCompressedTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + f, l, compressedFormat, level.width, level.height, 0, faceBytes, &level.data[faceBytes * f]);
+			}
+		}
+	}
+
+	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+	this->insert(key, texture, image.faceSize, image.faceSize, image.getSize());
+
+	return texture;
+}
+
+GLuint TextureCache::acquire(const std::string name, const unsigned char* pixels, int width, int height) {
+	if (pixels == nullptr) {
+		return 0;
+	}
+	return this->acquire(name, hashBytes(pixels, (size_t)width * height * 4), pixels, width, height);
+}
+
+GLuint TextureCache::stream(const std::string name, unsigned long long hash, const unsigned char* pixels, int width, int height, const std::vector<MipLevel> &mips) {
+	Key key(name, hash);
+	GLuint texture = this->find(key);
+	if (texture != 0 || pixels == nullptr) {
+		return texture;
+	}
+
+	// the streamer keeps its own copy until the last rows are up
+	std::vector<StreamLevel> levels(mips.size() + 1);
+	levels[0].width = width;
+	levels[0].height = height;
+	levels[0].data.assign(pixels, pixels + (size_t)width * height * 4);
+	size_t bytes = levels[0].data.size();
+	for (unsigned int l = 0; l < mips.size(); l++) {
+		levels[l + 1].width = mips[l].width;
+		levels[l + 1].height = mips[l].height;
+		levels[l + 1].data = mips[l].pixels;
+		bytes += mips[l].pixels.size();
+	}
+
+	texture = create(GL_TEXTURE_2D);
+	this->streamer.add(texture, GL_TEXTURE_2D, 0, levels);
+	this->insert(key, texture, width, height, bytes);
+
+	return texture;
+}
+
+GLuint TextureCache::stream(const std::string name, unsigned long long hash, const CompressedImage &image) {
+	Key key(name, hash);
+	GLuint texture = this->find(key);
+	if (texture != 0 || image.levels.empty() || !isCompressionSupported()) {
+		return texture;
+	}
+
+	std::vector<StreamLevel> levels(image.levels.size());
+	for (unsigned int l = 0; l < image.levels.size(); l++) {
+		levels[l].width = image.levels[l].width;
+		levels[l].height = image.levels[l].height;
+		levels[l].data = image.levels[l].data;
+	}
+
+	texture = create(GL_TEXTURE_2D);
+	this->streamer.add(texture, GL_TEXTURE_2D, image.format == TEXTURE_FORMAT_DXT1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, levels);
+	this->insert(key, texture, image.width, image.height, image.getSize());
+
+	return texture;
+}
+
+GLuint TextureCache::stream(const std::string name, unsigned long long hash, const CubemapImage &image) {
+	Key key(name, hash);
+	GLuint texture = this->find(key);
+	GLenum compressedFormat;
+	std::vector<StreamLevel> levels;
+	if (texture != 0 || !getCubemapLevels(image, compressedFormat, levels) || (compressedFormat != 0 && !isCompressionSupported())) {
+		return texture;
+	}
+
+	texture = create(GL_TEXTURE_CUBE_MAP);
+	this->streamer.add(texture, GL_TEXTURE_CUBE_MAP, compressedFormat, levels);
+	this->insert(key, texture, image.faceSize, image.faceSize, image.getSize());
+
+	return texture;
+}
+
+size_t TextureCache::update() {
+	return this->streamer.update();
+}
+
+void TextureCache::setStreamBudget(size_t bytes) {
+	this->streamer.setBudget(bytes);
+}
+
+unsigned int TextureCache::getNumStreaming() {
+	return this->streamer.getNumStreaming();
+}
+
+void TextureCache::addReference(GLuint texture) {
+	std::map<GLuint, Entry>::iterator found = this->entries.find(texture);
+	if (found != this->entries.end()) {
+		found->second.references++;
+	}
+}
+
+void TextureCache::release(GLuint texture) {
+	std::map<GLuint, Entry>::iterator found = this->entries.find(texture);
+	if (found == this->entries.end()) {
+		return;
+	}
+
+	if (--found->second.references > 0) {
+		return;
+	}
+
+	this->streamer.cancel(texture);
+	glDeleteTextures(1, &texture);
+	this->gpuBytes -= found->second.bytes;
+	this->textures.erase(found->second.key);
+	this->entries.erase(found);
+}
+
+void TextureCache::clear() {
+	for (std::map<GLuint, Entry>::iterator it = this->entries.begin(); it != this->entries.end(); ++it) {
+		glDeleteTextures(1, &it->first);
+	}
+	this->streamer.clear();
+
+	this->textures.clear();
+	this->entries.clear();
+	this->gpuBytes = 0;
+}
+
+bool TextureCache::isCompressionSupported() {
+	return GLEW_EXT_texture_compression_s3tc != GL_FALSE;
+}
+
+unsigned int TextureCache::getNumTextures() {
+	return this->entries.size();
+}
+
+size_t TextureCache::getGpuBytes() {
+	return this->gpuBytes;
+}
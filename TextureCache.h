@@ -0,0 +1,103 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <utility>
+
+#include <GL/glew.h>
+
+#include "CubemapGenerator.h"
+#include "MipmapGenerator.h"
+#include "TextureCompressor.h"
+#include "TextureStreamer.h"
+
+// Registry of GL textures keyed by name (usually the file path) and a 64-bit hash of
+// the content, so the same image is uploaded once however many meshes use it, and a
+// file that changed on disk is not mistaken for the old one. Each acquire adds a
+// reference; the texture is deleted when the last one is released.
+//
+// Textures are 8-bit RGBA, or DXT compressed by TextureCompressor, with a full mip
+// chain made on the CPU (see MipmapGenerator); cube maps come from CubemapGenerator. Large ones can be streamed in over
+// several frames instead (see TextureStreamer). All calls need the GL context.
+class TextureCache {
+private:
+	typedef std::pair<std::string, unsigned long long> Key;
+
+	struct Entry {
+		Key key;
+		int width;
+		int height;
+		size_t bytes;
+		unsigned int references;
+	};
+
+	std::map<Key, GLuint> textures;
+	std::map<GLuint, Entry> entries;
+	size_t gpuBytes;
+	TextureStreamer streamer;
+
+	TextureCache(const TextureCache&) = delete;
+	TextureCache& operator=(const TextureCache&) = delete;
+
+	GLuint find(const Key &key);
+	void insert(const Key &key, GLuint texture, int width, int height, size_t bytes);
+	// generates a texture with this cache's filtering, left bound to target
+	static GLuint create(GLenum target);
+	// A cube map's levels as TextureStreamer takes them, with the compressed format or 0.
+	// Returns false if there are no faces, or compressed faces differ in format.
+	static bool getCubemapLevels(const CubemapImage &image, GLenum &compressedFormat, std::vector<StreamLevel> &levels);
+
+public:
+	TextureCache();
+
+	// Loads and uploads an image file, or shares the texture already made from it.
+	// Returns 0 (and reports why) if the file cannot be decoded.
+	GLuint acquire(const std::string filename);
+
+	// Uploads pixels decoded elsewhere, e.g. on a loader thread, with the rest of their
+	// mip chain; hash identifies their source (see MappedFile::hashFile). Returns 0 for
+	// missing pixels.
+	GLuint acquire(const std::string name, unsigned long long hash, const unsigned char* pixels, int width, int height, const std::vector<MipLevel> &mips);
+
+	// The same, making the mip chain here with the Kaiser filter
+	GLuint acquire(const std::string name, unsigned long long hash, const unsigned char* pixels, int width, int height);
+
+	// Uploads an image compressed elsewhere, keyed like the pixels it was made from.
+	// Returns 0 for an image without levels or if the GL lacks S3TC (see isCompressionSupported).
+	GLuint acquire(const std::string name, unsigned long long hash, const CompressedImage &image);
+
+	// Uploads a cube map made elsewhere, compressed or not. Returns 0 for an image
+	// without faces, or compressed faces if the GL lacks S3TC.
+	GLuint acquire(const std::string name, unsigned long long hash, const CubemapImage &image);
+
+	// Pixels made in memory, keyed by name and a hash of the pixels themselves
+	GLuint acquire(const std::string name, const unsigned char* pixels, int width, int height);
+
+	// Like the acquires above, but only the coarsest level is uploaded now; the rest
+	// follow from update, so even a large image never holds up a frame
+	GLuint stream(const std::string name, unsigned long long hash, const unsigned char* pixels, int width, int height, const std::vector<MipLevel> &mips);
+	GLuint stream(const std::string name, unsigned long long hash, const CompressedImage &image);
+	GLuint stream(const std::string name, unsigned long long hash, const CubemapImage &image);
+
+	// Uploads the next part of the textures being streamed, within the budget (bytes
+	// per frame). Returns the bytes uploaded. Call once per frame.
+	size_t update();
+	void setStreamBudget(size_t bytes);
+	unsigned int getNumStreaming();
+
+	// another reference to a texture from this cache
+	void addReference(GLuint texture);
+
+	// Drops a reference, deleting the texture with the last one. 0 is ignored.
+	void release(GLuint texture);
+
+	// Deletes every texture whatever its references, e.g. before the context goes away
+	void clear();
+
+	// whether the GL takes the DXT formats TextureCompressor produces
+	static bool isCompressionSupported();
+
+	unsigned int getNumTextures();
+	// estimated GPU memory of all textures, mip chains included
+	size_t getGpuBytes();
+};
@@ -0,0 +1,361 @@
+#include "TextureCompressor.h"
+#include "CubemapGenerator.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "apis/stb_image.h"
+
+extern "C" {
+#include <soil/src/image_DXT.h>
+}
+
+#define DDS_MAGIC 0x20534444
+#define DDS_FOURCC(a, b, c, d) ((unsigned int)(a) | ((unsigned int)(b) << 8) | ((unsigned int)(c) << 16) | ((unsigned int)(d) << 24))
+
+// Marks the dwReserved1 words as ours: the tag, the layout version, then the
+// source's size, timestamp and hash as pairs of words, then the mip filter and, for
+// cube maps, how the faces were projected (0 for plain textures)
+#define TEXTURE_CACHE_TAG DDS_FOURCC('H', 'T', 'E', 'X')
+#define TEXTURE_CACHE_VERSION 2
+
+#define DDS_CUBEMAP_ALL_FACES (DDSCAPS2_CUBEMAP_POSITIVEX | DDSCAPS2_CUBEMAP_NEGATIVEX | DDSCAPS2_CUBEMAP_POSITIVEY | \
+	DDSCAPS2_CUBEMAP_NEGATIVEY | DDSCAPS2_CUBEMAP_POSITIVEZ | DDSCAPS2_CUBEMAP_NEGATIVEZ)
+
+static bool getFileInfo(const std::string &filename, unsigned long long &size, long long &modifiedTime) {
+	struct stat fileStat;
+	if (stat(filename.c_str(), &fileStat) != 0) {
+		return false;
+	}
+
+	size = (unsigned long long)fileStat.st_size;
+	modifiedTime = (long long)fileStat.st_mtime;
+	return true;
+}
+
+static size_t getLevelSize(int width, int height, unsigned int format) {
+	size_t blockBytes = format == TEXTURE_FORMAT_DXT1 ? DXT1_BLOCK_BYTES : DXT5_BLOCK_BYTES;
+	return (size_t)((width + 3) / 4) * ((height + 3) / 4) * blockBytes;
+}
+
+// A full chain halves the larger side down to 1, so floor(log2(max(w, h))) + 1 levels
+static unsigned int getMaxLevels(unsigned int width, unsigned int height) {
+	unsigned int levels = 1;
+	for (unsigned int size = std::max(width, height); size > 1; size /= 2) {
+		levels++;
+	}
+	return levels;
+}
+
+size_t CompressedImage::getSize() const {
+	size_t size = 0;
+	for (const CompressedLevel &level : this->levels) {
+		size += level.data.size();
+	}
+	return size;
+}
+
+size_t CompressedImage::getUncompressedSize() const {
+	size_t size = 0;
+	for (const CompressedLevel &level : this->levels) {
+		size += (size_t)level.width * level.height * 4;
+	}
+	return size;
+}
+
+std::string TextureCompressor::getCacheFilename(const std::string sourceFilename) {
+	return sourceFilename + ".dds";
+}
+
+std::string TextureCompressor::getCubemapCacheFilename(const std::string sourceFilename) {
+	return sourceFilename + ".cube.dds";
+}
+
+void TextureCompressor::compress(const unsigned char* pixels, int width, int height, const int mipFilter, CompressedImage &image) {
+	// the mip chain halves (rounding down) to 1x1, as GL expects it
+	std::vector<MipLevel> mips;
+	MipmapGenerator::generate(pixels, width, height, mipFilter, true, mips);
+	compress(pixels, width, height, mipFilter, mips, image);
+}
+
+void TextureCompressor::compress(const unsigned char* pixels, int width, int height, const int mipFilter, const std::vector<MipLevel> &mips, CompressedImage &image) {
+	image.width = width;
+	image.height = height;
+	image.mipFilter = mipFilter;
+	image.levels.clear();
+
+	// DXT1 has no alpha worth speaking of, so it is only used for opaque images
+	image.format = TEXTURE_FORMAT_DXT1;
+	for (size_t i = 3; i < (size_t)width * height * 4; i += 4) {
+		if (pixels[i] != 255) {
+			image.format = TEXTURE_FORMAT_DXT5;
+			break;
+		}
+	}
+
+	std::vector<const unsigned char*> sources(1, pixels);
+	for (const MipLevel &mip : mips) {
+		sources.push_back(mip.pixels.data());
+	}
+
+	for (size_t l = 0; l < sources.size(); l++) {
+		CompressedLevel level;
+		level.width = l == 0 ? width : mips[l - 1].width;
+		level.height = l == 0 ? height : mips[l - 1].height;
+		level.data.resize(getLevelSize(level.width, level.height, image.format));
+		image.levels.push_back(level);
+	}
+
+	// Blocks only depend on their own pixels, so strips of whole block rows compress
+	// straight into their place in the level, each on whichever thread takes it
+	struct Strip {
+		unsigned int level;
+		int firstRow;
+		int numRows;
+	};
+	std::vector<Strip> strips;
+	for (unsigned int l = 0; l < image.levels.size(); l++) {
+		for (int y = 0; y < image.levels[l].height; y += TEXTURE_COMPRESS_STRIP_BLOCKS * 4) {
+			Strip strip;
+			strip.level = l;
+			strip.firstRow = y;
+			strip.numRows = std::min(TEXTURE_COMPRESS_STRIP_BLOCKS * 4, image.levels[l].height - y);
+			strips.push_back(strip);
+		}
+	}
+
+	ThreadPool::getShared().parallelFor(strips.size(), [&image, &strips, &sources](unsigned int i) {
+		const Strip &strip = strips[i];
+		CompressedLevel &level = image.levels[strip.level];
+		const unsigned char* source = sources[strip.level];
+
+		unsigned char* compressed = &level.data[getLevelSize(level.width, strip.firstRow, image.format)];
+		int firstBlockRow = strip.firstRow / 4;
+		int numBlockRows = (strip.numRows + 3) / 4;
+		if (image.format == TEXTURE_FORMAT_DXT1) {
+			convert_image_rows_to_DXT1(source, level.width, level.height, 4, firstBlockRow, numBlockRows, compressed);
+		}
+		else {
+			convert_image_rows_to_DXT5(source, level.width, level.height, 4, firstBlockRow, numBlockRows, compressed);
+		}
+	});
+}
+
+// Reads numFaces images, each a whole mip chain, that follow the header back to back;
+// one image is a plain texture and six a cube map. Nothing is changed unless the cache
+// was made from the current contents of sourceFilename with mipFilter and projection.
+static bool readFaces(const std::string cacheFilename, const std::string sourceFilename, const int mipFilter, const unsigned int projection,
+	CompressedImage *faces, unsigned int numFaces) {
+	MappedFile file;
+	if (!file.open(cacheFilename) || file.getSize() < sizeof(DDS_header)) {
+		return false;
+	}
+
+	DDS_header header;
+	memcpy(&header, file.getData(), sizeof(header));
+
+	if (header.dwMagic != DDS_MAGIC || header.dwReserved1[0] != TEXTURE_CACHE_TAG || header.dwReserved1[1] != TEXTURE_CACHE_VERSION ||
+		(int)header.dwReserved1[8] != mipFilter || header.dwReserved1[9] != projection) {
+		return false;
+	}
+
+	bool cubemap = (header.sCaps.dwCaps2 & DDSCAPS2_CUBEMAP) != 0;
+	if (cubemap != (numFaces == CUBEMAP_FACES) || (cubemap && (header.sCaps.dwCaps2 & DDS_CUBEMAP_ALL_FACES) != DDS_CUBEMAP_ALL_FACES)) {
+		return false;
+	}
+
+	unsigned int format;
+	if (header.sPixelFormat.dwFourCC == DDS_FOURCC('D', 'X', 'T', '1')) {
+		format = TEXTURE_FORMAT_DXT1;
+	}
+	else if (header.sPixelFormat.dwFourCC == DDS_FOURCC('D', 'X', 'T', '5')) {
+		format = TEXTURE_FORMAT_DXT5;
+	}
+	else {
+		return false;
+	}
+
+	// the level count sizes an allocation, so it is checked before it is trusted
+	if (header.dwWidth == 0 || header.dwHeight == 0 || header.dwMipMapCount == 0 ||
+		header.dwMipMapCount > getMaxLevels(header.dwWidth, header.dwHeight)) {
+		return false;
+	}
+
+	unsigned long long cachedSize, cachedHash;
+	long long cachedModifiedTime;
+	memcpy(&cachedSize, &header.dwReserved1[2], sizeof(cachedSize));
+	memcpy(&cachedModifiedTime, &header.dwReserved1[4], sizeof(cachedModifiedTime));
+	memcpy(&cachedHash, &header.dwReserved1[6], sizeof(cachedHash));
+
+	// the timestamp is the cheap check; if only it changed, compare the contents
+	unsigned long long sourceSize;
+	long long sourceModifiedTime;
+	if (!getFileInfo(sourceFilename, sourceSize, sourceModifiedTime) || sourceSize != cachedSize) {
+		return false;
+	}
+	if (sourceModifiedTime != cachedModifiedTime && MappedFile::hashFile(sourceFilename) != cachedHash) {
+		return false;
+	}
+
+	// the levels of each face follow the header back to back, then those of the next face
+	std::vector<std::vector<CompressedLevel>> faceLevels(numFaces);
+	size_t offset = sizeof(DDS_header);
+	for (std::vector<CompressedLevel> &levels : faceLevels) {
+		levels.resize(header.dwMipMapCount);
+		int levelWidth = header.dwWidth, levelHeight = header.dwHeight;
+		for (CompressedLevel &level : levels) {
+			size_t size = getLevelSize(levelWidth, levelHeight, format);
+			if (offset + size > file.getSize()) {
+				return false;
+			}
+
+			level.width = levelWidth;
+			level.height = levelHeight;
+			level.data.assign(file.getData() + offset, file.getData() + offset + size);
+			offset += size;
+
+			levelWidth = std::max(levelWidth / 2, 1);
+			levelHeight = std::max(levelHeight / 2, 1);
+		}
+	}
+	if (offset != file.getSize()) {
+		return false;
+	}
+
+	for (unsigned int f = 0; f < numFaces; f++) {
+		faces[f].hash = cachedHash;
+		faces[f].width = header.dwWidth;
+		faces[f].height = header.dwHeight;
+		faces[f].format = format;
+		faces[f].mipFilter = mipFilter;
+		faces[f].levels.swap(faceLevels[f]);
+	}
+	return true;
+}
+
+// Writes numFaces images, which must match in size, format and levels, as readFaces reads them
+static bool writeFaces(const std::string cacheFilename, const std::string sourceFilename, const unsigned int projection,
+	const CompressedImage *faces, unsigned int numFaces) {
+	const CompressedImage &image = faces[0];
+	for (unsigned int f = 0; f < numFaces; f++) {
+		if (faces[f].levels.empty() || faces[f].width != image.width || faces[f].height != image.height ||
+			faces[f].format != image.format || faces[f].levels.size() != image.levels.size()) {
+			return false;
+		}
+	}
+
+	DDS_header header;
+	memset(&header, 0, sizeof(header));
+	header.dwMagic = DDS_MAGIC;
+	header.dwSize = 124;
+	header.dwFlags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_LINEARSIZE | DDSD_MIPMAPCOUNT;
+	header.dwWidth = image.width;
+	header.dwHeight = image.height;
+	header.dwPitchOrLinearSize = image.levels[0].data.size();
+	header.dwMipMapCount = image.levels.size();
+	header.sPixelFormat.dwSize = 32;
+	header.sPixelFormat.dwFlags = DDPF_FOURCC;
+	header.sPixelFormat.dwFourCC = image.format == TEXTURE_FORMAT_DXT1 ? DDS_FOURCC('D', 'X', 'T', '1') : DDS_FOURCC('D', 'X', 'T', '5');
+	header.sCaps.dwCaps1 = DDSCAPS_TEXTURE | DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+	if (numFaces == CUBEMAP_FACES) {
+		header.sCaps.dwCaps2 = DDSCAPS2_CUBEMAP | DDS_CUBEMAP_ALL_FACES;
+	}
+
+	unsigned long long sourceSize;
+	long long sourceModifiedTime;
+	if (!getFileInfo(sourceFilename, sourceSize, sourceModifiedTime)) {
+		return false;
+	}
+	unsigned long long sourceHash = image.hash != 0 ? image.hash : MappedFile::hashFile(sourceFilename);
+
+	header.dwReserved1[0] = TEXTURE_CACHE_TAG;
+	header.dwReserved1[1] = TEXTURE_CACHE_VERSION;
+	memcpy(&header.dwReserved1[2], &sourceSize, sizeof(sourceSize));
+	memcpy(&header.dwReserved1[4], &sourceModifiedTime, sizeof(sourceModifiedTime));
+	memcpy(&header.dwReserved1[6], &sourceHash, sizeof(sourceHash));
+	header.dwReserved1[8] = image.mipFilter;
+	header.dwReserved1[9] = projection;
+
+	// write to a temporary file first so a reader never maps a half written cache
+	std::string temporaryFilename = cacheFilename + ".tmp";
+	std::ofstream fileOut(temporaryFilename.c_str(), std::ios::binary | std::ios::trunc);
+
+	if (!fileOut.is_open()) {
+		return false;
+	}
+
+	fileOut.write((const char*)&header, sizeof(header));
+	for (unsigned int f = 0; f < numFaces; f++) {
+		for (const CompressedLevel &level : faces[f].levels) {
+			fileOut.write((const char*)level.data.data(), level.data.size());
+		}
+	}
+	fileOut.close();
+
+	if (!fileOut) {
+		remove(temporaryFilename.c_str());
+		return false;
+	}
+
+	remove(cacheFilename.c_str());
+	return rename(temporaryFilename.c_str(), cacheFilename.c_str()) == 0;
+}
+
+bool TextureCompressor::readDds(const std::string cacheFilename, const std::string sourceFilename, const int mipFilter, CompressedImage &image) {
+	return readFaces(cacheFilename, sourceFilename, mipFilter, 0, &image, 1);
+}
+
+bool TextureCompressor::writeDds(const std::string cacheFilename, const std::string sourceFilename, const CompressedImage &image) {
+	return writeFaces(cacheFilename, sourceFilename, 0, &image, 1);
+}
+
+bool TextureCompressor::readDdsCubemap(const std::string cacheFilename, const std::string sourceFilename, const int mipFilter, const unsigned int projection,
+	std::vector<CompressedImage> &faces) {
+	std::vector<CompressedImage> read(CUBEMAP_FACES);
+	if (!readFaces(cacheFilename, sourceFilename, mipFilter, projection, read.data(), CUBEMAP_FACES)) {
+		return false;
+	}
+	faces.swap(read);
+	return true;
+}
+
+bool TextureCompressor::writeDdsCubemap(const std::string cacheFilename, const std::string sourceFilename, const unsigned int projection,
+	const std::vector<CompressedImage> &faces) {
+	if (faces.size() != CUBEMAP_FACES) {
+		return false;
+	}
+	return writeFaces(cacheFilename, sourceFilename, projection, faces.data(), CUBEMAP_FACES);
+}
+
+bool TextureCompressor::load(const std::string filename, const int mipFilter, CompressedImage &image) {
+	std::string cacheFilename = getCacheFilename(filename);
+	image.filename = filename;
+	image.fromCache = readDds(cacheFilename, filename, mipFilter, image);
+	if (image.fromCache) {
+		return true;
+	}
+
+	int width, height, numComponents;
+	unsigned char* pixels = stbi_load(filename.c_str(), &width, &height, &numComponents, 4);
+	if (pixels == nullptr) {
+		image.error = stbi_failure_reason();
+		return false;
+	}
+
+	image.hash = MappedFile::hashFile(filename);
+	compress(pixels, width, height, mipFilter, image);
+	stbi_image_free(pixels);
+
+	if (!writeDds(cacheFilename, filename, image)) {
+		std::cout << "  could not write cache " << cacheFilename << std::endl;
+	}
+	return true;
+}
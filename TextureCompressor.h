@@ -0,0 +1,88 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "MipmapGenerator.h"
+
+// Block compressed formats TextureCompressor produces, as in the DDS FourCC
+#define TEXTURE_FORMAT_DXT1 1
+#define TEXTURE_FORMAT_DXT5 5
+
+// Each mip level is compressed in strips of this many 4x4 block rows, one per task
+#define TEXTURE_COMPRESS_STRIP_BLOCKS 16
+
+// Bytes of one 4x4 block
+#define DXT1_BLOCK_BYTES 8
+#define DXT5_BLOCK_BYTES 16
+
+// One level of the mip chain, as glCompressedTexImage2D takes it
+struct CompressedLevel {
+	int width;
+	int height;
+	std::vector<unsigned char> data;
+};
+
+// A DXT compressed image with its full mip chain (level 0 first)
+struct CompressedImage {
+	std::string filename;
+	// of the source file's contents (see MappedFile::hashFile), for TextureCache
+	unsigned long long hash;
+	int width;
+	int height;
+	unsigned int format;
+	// MIPMAP_FILTER_BOX or MIPMAP_FILTER_KAISER, whichever made the mip chain
+	int mipFilter;
+	std::vector<CompressedLevel> levels;
+	// read from the DDS cache rather than decoded and compressed
+	bool fromCache;
+	// why there are no levels
+	std::string error;
+
+	CompressedImage() : hash(0), width(0), height(0), format(TEXTURE_FORMAT_DXT1), mipFilter(MIPMAP_FILTER_BOX), fromCache(false) {}
+
+	// compressed bytes of every level
+	size_t getSize() const;
+	// what the same mip chain takes as 8-bit RGBA
+	size_t getUncompressedSize() const;
+};
+
+// Compresses images to DXT1 (opaque) or DXT5 (with alpha) with SOIL's image_DXT
+// encoder, and caches the result as a .dds next to the source image so later runs
+// read the finished mip chain instead of decoding and compressing again. The cache
+// records the source's size, timestamp and hash in the header's reserved words, the
+// same staleness check MeshCache uses, and the filter the mip chain was made with.
+//
+// Nothing here touches GL, so it all runs on loader threads; see TextureCache for the upload.
+class TextureCompressor {
+public:
+	static std::string getCacheFilename(const std::string sourceFilename);
+	static std::string getCubemapCacheFilename(const std::string sourceFilename);
+
+	// Builds the mip chain of 8-bit sRGB pixels with mipFilter (see MipmapGenerator) and
+	// compresses every level, spreading the strips of all levels over the shared thread pool
+	static void compress(const unsigned char* pixels, int width, int height, const int mipFilter, CompressedImage &image);
+
+	// The same with the mip chain (levels 1 and down) already made by MipmapGenerator
+	static void compress(const unsigned char* pixels, int width, int height, const int mipFilter, const std::vector<MipLevel> &mips, CompressedImage &image);
+
+	// Fills image from cacheFilename if it was built from the current contents of
+	// sourceFilename with mipFilter. Returns false if the cache is missing or stale.
+	static bool readDds(const std::string cacheFilename, const std::string sourceFilename, const int mipFilter, CompressedImage &image);
+
+	static bool writeDds(const std::string cacheFilename, const std::string sourceFilename, const CompressedImage &image);
+
+	// The same for the six faces of a cube map, in the GL order (see CubemapGenerator.h),
+	// stored one after the other with their mip chains in a DDS marked DDSCAPS2_CUBEMAP.
+	// projection identifies how the faces were made from the source, e.g. a hash of the
+	// cube's orientation; a cache made with another one is stale.
+	static bool readDdsCubemap(const std::string cacheFilename, const std::string sourceFilename, const int mipFilter, const unsigned int projection,
+		std::vector<CompressedImage> &faces);
+
+	static bool writeDdsCubemap(const std::string cacheFilename, const std::string sourceFilename, const unsigned int projection,
+		const std::vector<CompressedImage> &faces);
+
+	// Reads the cache of filename, or decodes, compresses and writes it. Returns false
+	// (with image.error set) if the image cannot be decoded.
+	static bool load(const std::string filename, const int mipFilter, CompressedImage &image);
+};
@@ -0,0 +1,239 @@
+#include "TextureStreamer.h"
+
+#include <algorithm>
+#include <cstring>
+
+TextureStreamer::TextureStreamer() {
+	for (unsigned int i = 0; i < TEXTURE_STREAM_BUFFERS; i++) {
+		this->buffers[i] = 0;
+	}
+	this->nextBuffer = 0;
+	this->budget = TEXTURE_STREAM_BUDGET;
+}
+
+size_t TextureStreamer::getRowBytes(const Job &job, const StreamLevel &level) {
+	if (job.compressedFormat == 0) {
+		return (size_t)level.width * 4;
+	}
+	size_t blockBytes = job.compressedFormat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ? 8 : 16;
+	return (size_t)((level.width + 3) / 4) * blockBytes;
+}
+
+int TextureStreamer::getNumFaceRows(const Job &job, const StreamLevel &level) {
+	return job.compressedFormat == 0 ? level.height : (level.height + 3) / 4;
+}
+
+int TextureStreamer::getNumRows(const Job &job, const StreamLevel &level) {
+	return getNumFaceRows(job, level) * (job.target == GL_TEXTURE_CUBE_MAP ? 6 : 1);
+}
+
+void TextureStreamer::uploadRows(const Job &job, int level, int firstRow, int numRows, const void* pixels) {
+	const StreamLevel &streamLevel = job.levels[level];
+	size_t rowBytes = getRowBytes(job, streamLevel);
+	int numFaceRows = getNumFaceRows(job, streamLevel);
+
+	// one upload per face the rows fall in
+	while (numRows > 0) {
+		int face = firstRow / numFaceRows;
+		int faceRow = firstRow % numFaceRows;
+		int faceRows = std::min(numRows, numFaceRows - faceRow);
+		GLenum target = job.target == GL_TEXTURE_CUBE_MAP ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : job.target;
+
+		if (job.compressedFormat == 0) {
+			glTexSubImage2D(target, level, 0, faceRow, streamLevel.width, faceRows, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+		}
+		else {
+			// block rows, the last of which may be cut short by the edge of the level
+			int y = faceRow * 4;
+			int height = std::min(faceRows * 4, streamLevel.height - y);
+			glCompressedTexSubImage2D(target, level, 0, y, streamLevel.width, height, job.compressedFormat, rowBytes * faceRows, pixels);
+		}
+
+		firstRow += faceRows;
+		numRows -= faceRows;
+		pixels = (const unsigned char*)pixels + rowBytes * faceRows;
+	}
+}
+
+void TextureStreamer::setBudget(size_t bytes) {
+	this->budget = bytes;
+}
+
+size_t TextureStreamer::getBudget() {
+	return this->budget;
+}
+
+void TextureStreamer::add(GLuint texture, GLenum target, GLenum compressedFormat, std::vector<StreamLevel> &levels) {
+	if (levels.empty()) {
+		return;
+	}
+
+	Job job;
+	job.texture = texture;
+	job.target = target;
+	job.compressedFormat = compressedFormat;
+	job.levels.swap(levels);
+	job.level = job.levels.size() - 1;
+	job.row = 0;
+
+	glBindTexture(target, texture);
+
+	// storage for the whole chain up front, so levels can be filled in any order
+	unsigned int numFaces = target == GL_TEXTURE_CUBE_MAP ? 6 : 1;
+	for (unsigned int l = 0; l < job.levels.size(); l++) {
+		const StreamLevel &level = job.levels[l];
+		for (unsigned int face = 0; face < numFaces; face++) {
+			GLenum faceTarget = target == GL_TEXTURE_CUBE_MAP ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : target;
+			if (compressedFormat == 0) {
+				glTexImage2D(faceTarget, l, GL_RGBA8, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+			}
+			else {
+				glCompressedTexImage2D(faceTarget, l, compressedFormat, level.width, level.height, 0, level.data.size() / numFaces, nullptr);
+			}
+		}
+	}
+
+	// the coarsest level goes up straight away, so there is always something to draw
+	uploadRows(job, job.level, 0, getNumRows(job, job.levels[job.level]), job.levels[job.level].data.data());
+	glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, job.level);
+	glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, job.level);
+
+	glBindTexture(target, 0);
+
+	job.level--;
+	if (job.level >= 0) {
+		this->jobs.push_back(job);
+	}
+}
+
+void TextureStreamer::cancel(GLuint texture) {
+	for (std::vector<Job>::iterator it = this->jobs.begin(); it != this->jobs.end(); ++it) {
+		if (it->texture == texture) {
+			this->jobs.erase(it);
+			return;
+		}
+	}
+}
+
+size_t TextureStreamer::update() {
+	if (this->jobs.empty()) {
+		return 0;
+	}
+
+	// Plan this frame's rows first, so the pixel buffer is mapped once at its final size
+	struct Chunk {
+		unsigned int job;
+		int level;
+		int firstRow;
+		int numRows;
+		size_t offset;
+	};
+	std::vector<Chunk> chunks;
+	size_t size = 0;
+
+	for (unsigned int j = 0; j < this->jobs.size() && size < this->budget; j++) {
+		const Job &job = this->jobs[j];
+		int level = job.level, row = job.row;
+
+		while (level >= 0 && size < this->budget) {
+			const StreamLevel &streamLevel = job.levels[level];
+			size_t rowBytes = getRowBytes(job, streamLevel);
+			int numRows = std::min((size_t)(getNumRows(job, streamLevel) - row), (this->budget - size) / rowBytes);
+			// a row larger than the whole budget still has to go some time
+			if (numRows == 0 && size == 0) {
+				numRows = 1;
+			}
+			if (numRows == 0) {
+				break;
+			}
+
+			Chunk chunk;
+			chunk.job = j;
+			chunk.level = level;
+			chunk.firstRow = row;
+			chunk.numRows = numRows;
+			chunk.offset = size;
+			chunks.push_back(chunk);
+			size += rowBytes * numRows;
+
+			row += numRows;
+			if (row == getNumRows(job, streamLevel)) {
+				level--;
+				row = 0;
+			}
+		}
+	}
+
+	if (this->buffers[0] == 0) {
+		glGenBuffers(TEXTURE_STREAM_BUFFERS, this->buffers);
+	}
+	GLuint buffer = this->buffers[this->nextBuffer];
+	this->nextBuffer = (this->nextBuffer + 1) % TEXTURE_STREAM_BUFFERS;
+
+	// orphaning the old contents lets the driver hand out fresh memory rather than wait
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+	unsigned char* mapped = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	if (mapped == nullptr) {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		return 0;
+	}
+
+	for (const Chunk &chunk : chunks) {
+		const Job &job = this->jobs[chunk.job];
+		const StreamLevel &streamLevel = job.levels[chunk.level];
+		size_t rowBytes = getRowBytes(job, streamLevel);
+		memcpy(mapped + chunk.offset, &streamLevel.data[rowBytes * chunk.firstRow], rowBytes * chunk.numRows);
+	}
+	glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+	// with a pixel buffer bound, the pointers the uploads take are offsets into it
+	for (const Chunk &chunk : chunks) {
+		Job &job = this->jobs[chunk.job];
+		glBindTexture(job.target, job.texture);
+		uploadRows(job, chunk.level, chunk.firstRow, chunk.numRows, (const void*)chunk.offset);
+
+		job.row = chunk.firstRow + chunk.numRows;
+		if (job.row == getNumRows(job, job.levels[chunk.level])) {
+			// the level is whole, so sampling may reach down to it
+			glTexParameteri(job.target, GL_TEXTURE_BASE_LEVEL, chunk.level);
+			job.level = chunk.level - 1;
+			job.row = 0;
+		}
+		glBindTexture(job.target, 0);
+	}
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	// finished textures no longer need their copy of the pixels
+	this->jobs.erase(std::remove_if(this->jobs.begin(), this->jobs.end(), [](const Job &job) {
+		return job.level < 0;
+	}), this->jobs.end());
+
+	return size;
+}
+
+void TextureStreamer::clear() {
+	this->jobs.clear();
+	if (this->buffers[0] != 0) {
+		glDeleteBuffers(TEXTURE_STREAM_BUFFERS, this->buffers);
+		for (unsigned int i = 0; i < TEXTURE_STREAM_BUFFERS; i++) {
+			this->buffers[i] = 0;
+		}
+	}
+}
+
+unsigned int TextureStreamer::getNumStreaming() {
+	return this->jobs.size();
+}
+
+size_t TextureStreamer::getPendingBytes() {
+	size_t bytes = 0;
+	for (const Job &job : this->jobs) {
+		for (int l = job.level; l >= 0; l--) {
+			bytes += job.levels[l].data.size();
+		}
+		bytes -= getRowBytes(job, job.levels[job.level]) * job.row;
+	}
+	return bytes;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vector>
+
+#include <GL/glew.h>
+
+// Bytes uploaded per frame unless TextureStreamer::setBudget says otherwise
+#define TEXTURE_STREAM_BUDGET (1024 * 1024)
+
+// Pixel buffers the uploads rotate through, so a frame's copy never waits on the
+// buffer the GPU is still reading for the frame before
+#define TEXTURE_STREAM_BUFFERS 3
+
+// One level of a texture to stream: 8-bit RGBA pixels, or DXT blocks. A cube map's
+// six faces follow each other, in the GL order.
+struct StreamLevel {
+	int width;
+	int height;
+	std::vector<unsigned char> data;
+};
+
+// Uploads textures a little at a time instead of all at once. A texture's coarsest
+// level is uploaded as soon as it is added and the finer ones follow over later
+// frames, rows (or block rows) at a time through a ring of pixel buffer objects, at
+// most the budget per frame. GL_TEXTURE_BASE_LEVEL is kept at the finest complete
+// level, so the texture can be drawn throughout, blurry at first.
+//
+// Used by TextureCache, which owns the textures; all calls need the GL context.
+class TextureStreamer {
+private:
+	struct Job {
+		GLuint texture;
+		// GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP
+		GLenum target;
+		// 0 for RGBA8 pixels, otherwise the S3TC internal format
+		GLenum compressedFormat;
+		std::vector<StreamLevel> levels;
+		// the level being uploaded, counting down to 0, and its rows done so far, the
+		// rows of all of its faces counted as one
+		int level;
+		int row;
+	};
+
+	std::vector<Job> jobs;
+	GLuint buffers[TEXTURE_STREAM_BUFFERS];
+	unsigned int nextBuffer;
+	size_t budget;
+
+	TextureStreamer(const TextureStreamer&) = delete;
+	TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+	// bytes of one row of a level: a row of pixels, or a row of 4x4 blocks
+	static size_t getRowBytes(const Job &job, const StreamLevel &level);
+	static int getNumFaceRows(const Job &job, const StreamLevel &level);
+	static int getNumRows(const Job &job, const StreamLevel &level);
+
+	// uploads rows of a level from pixels, or from an offset into the bound pixel buffer
+	static void uploadRows(const Job &job, int level, int firstRow, int numRows, const void* pixels);
+
+public:
+	TextureStreamer();
+
+	void setBudget(size_t bytes);
+	size_t getBudget();
+
+	// Allocates every level of texture, uploads the coarsest and queues the rest. levels
+	// (level 0 first, halving to 1x1) are taken over, leaving the vector empty.
+	void add(GLuint texture, GLenum target, GLenum compressedFormat, std::vector<StreamLevel> &levels);
+
+	// stops streaming a texture, e.g. one about to be deleted
+	void cancel(GLuint texture);
+
+	// Uploads the next rows of the queued textures, oldest first, up to the budget.
+	// Returns the bytes uploaded. Call once per frame.
+	size_t update();
+
+	// drops the queue and deletes the pixel buffers
+	void clear();
+
+	unsigned int getNumStreaming();
+	// bytes still to upload
+	size_t getPendingBytes();
+};
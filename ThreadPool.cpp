@@ -0,0 +1,118 @@
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <memory>
+
+ThreadPool::ThreadPool(unsigned int numThreads) {
+	this->stopping = false;
+
+	if (numThreads == 0) {
+		numThreads = std::thread::hardware_concurrency();
+	}
+	if (numThreads == 0) {
+		numThreads = 1;
+	}
+
+	for (unsigned int i = 0; i < numThreads; i++) {
+		this->workers.push_back(std::thread(&ThreadPool::workerLoop, this));
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->stopping = true;
+	}
+	this->condition.notify_all();
+
+	for (std::thread &worker : this->workers) {
+		worker.join();
+	}
+}
+
+void ThreadPool::workerLoop() {
+	while (true) {
+		std::function<void()> task;
+
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+			this->condition.wait(lock, [this] { return this->stopping || !this->tasks.empty(); });
+
+			if (this->tasks.empty()) {
+				return;
+			}
+
+			task = std::move(this->tasks.front());
+			this->tasks.pop_front();
+		}
+
+		task();
+	}
+}
+
+void ThreadPool::enqueue(std::function<void()> task) {
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->tasks.push_back(std::move(task));
+	}
+	this->condition.notify_one();
+}
+
+// State for one parallelFor call. Helpers may still be queued after the caller
+// returns, so it is shared rather than living on the caller's stack.
+struct ParallelForState {
+	std::function<void(unsigned int)> task;
+	unsigned int count;
+	std::atomic<unsigned int> next;
+	std::atomic<unsigned int> finished;
+	std::mutex mutex;
+	std::condition_variable done;
+
+	// Claims and runs indices until none are left
+	void run() {
+		unsigned int i;
+		while ((i = this->next.fetch_add(1)) < this->count) {
+			this->task(i);
+
+			if (this->finished.fetch_add(1) + 1 == this->count) {
+				std::lock_guard<std::mutex> lock(this->mutex);
+				this->done.notify_all();
+			}
+		}
+	}
+};
+
+void ThreadPool::parallelFor(unsigned int count, std::function<void(unsigned int)> task) {
+	if (count == 0) {
+		return;
+	}
+
+	std::shared_ptr<ParallelForState> state = std::make_shared<ParallelForState>();
+	state->task = std::move(task);
+	state->count = count;
+	state->next = 0;
+	state->finished = 0;
+
+	unsigned int numHelpers = count - 1;
+	if (numHelpers > this->workers.size()) {
+		numHelpers = this->workers.size();
+	}
+	for (unsigned int i = 0; i < numHelpers; i++) {
+		this->enqueue([state] { state->run(); });
+	}
+
+	// the calling thread works too, so nested calls from a worker cannot deadlock
+	state->run();
+
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->done.wait(lock, [&state] { return state->finished.load() == state->count; });
+}
+
+unsigned int ThreadPool::getNumThreads() {
+	return this->workers.size();
+}
+
+ThreadPool& ThreadPool::getShared() {
+	static ThreadPool pool;
+	return pool;
+}
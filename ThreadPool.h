@@ -0,0 +1,39 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads pulling tasks from a shared queue.
+class ThreadPool {
+private:
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> tasks;
+	std::mutex mutex;
+	std::condition_variable condition;
+	bool stopping;
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	void workerLoop();
+
+public:
+	// numThreads == 0 uses one thread per hardware thread
+	explicit ThreadPool(unsigned int numThreads = 0);
+	~ThreadPool();
+
+	void enqueue(std::function<void()> task);
+
+	// Runs task(i) for every i in [0, count) on the workers and the calling thread,
+	// and returns once all of them have finished. Safe to call from a worker.
+	void parallelFor(unsigned int count, std::function<void(unsigned int)> task);
+
+	unsigned int getNumThreads();
+
+	// Pool shared by the loaders, created on first use
+	static ThreadPool& getShared();
+};
@@ -1,36 +1,18 @@
 #pragma once
 
-#include <iostream>
-#include <string>
-#include <vector>
-#include <glm/glm.hpp>
+#include "ProceduralMesh.h"
 
-class UVCylinder {
+// Capped cylinder around the y axis, from -height/2 to height/2
+class UVCylinder : public ProceduralMesh {
 private:
-	unsigned int numSegments;
 	float radius;
-
-	std::vector<glm::vec3> positions;
-	std::vector<glm::vec2> textureCoords;
-	std::vector<glm::vec3> normals;
-	unsigned int numVertices;
-	unsigned int numTriangles;
-	unsigned int* triangleIndices;
+	float height;
+	unsigned int numSegments;
 
 public:
-	UVCylinder(float radius, unsigned int numSegments) : radius(radius), numSegments(numSegments) {}
-
-	glm::vec3* getPositions();
-	glm::vec2* getTextureCoords();
-	glm::vec3* getNormals();
-
-	unsigned int getNumVertices();
-	unsigned int getNumTriangles();
-
-	unsigned int* getTriangleIndices();
+	UVCylinder(float radius, unsigned int numSegments, float height = 2.0f);
 
 	float getRadius();
+	float getHeight();
 	unsigned int getNumSegments();
-
-	void save(const std::string filename);
-};
\ No newline at end of file
+};
@@ -0,0 +1,26 @@
+#include "UVSphere.h"
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+UVSphere::UVSphere(float radius, unsigned int numSlices, unsigned int numStacks) : radius(radius), numSlices(numSlices), numStacks(numStacks) {
+	// a half circle from the south pole to the north pole
+	std::vector<LathePoint> outline(numStacks + 1);
+	for (unsigned int j = 0; j <= numStacks; j++) {
+		double phi = M_PI * j / numStacks - M_PI * 0.5;
+		float c = (j == 0 || j == numStacks) ? 0.0f : (float)cos(phi);
+		float s = (float)sin(phi);
+
+		outline[j].radius = radius * c;
+		outline[j].y = radius * s;
+		outline[j].normalRadius = c;
+		outline[j].normalY = s;
+		outline[j].v = (float)j / numStacks;
+	}
+
+	this->addLathe(outline, numSlices);
+}
+
+float UVSphere::getRadius() { return this->radius; }
+unsigned int UVSphere::getNumSlices() { return this->numSlices; }
+unsigned int UVSphere::getNumStacks() { return this->numStacks; }
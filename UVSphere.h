@@ -0,0 +1,18 @@
+#pragma once
+
+#include "ProceduralMesh.h"
+
+// Sphere with numSlices segments around the y axis and numStacks from pole to pole
+class UVSphere : public ProceduralMesh {
+private:
+	float radius;
+	unsigned int numSlices;
+	unsigned int numStacks;
+
+public:
+	UVSphere(float radius, unsigned int numSlices, unsigned int numStacks);
+
+	float getRadius();
+	unsigned int getNumSlices();
+	unsigned int getNumStacks();
+};
@@ -0,0 +1,28 @@
+#include "UVTorus.h"
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+UVTorus::UVTorus(float ringRadius, float tubeRadius, unsigned int ringSegments, unsigned int tubeSegments)
+	: ringRadius(ringRadius), tubeRadius(tubeRadius), ringSegments(ringSegments), tubeSegments(tubeSegments) {
+	// the tube's cross section, once round from the outer equator
+	std::vector<LathePoint> outline(tubeSegments + 1);
+	for (unsigned int j = 0; j <= tubeSegments; j++) {
+		double phi = (M_PI * 2.0) * (j % tubeSegments) / tubeSegments;
+		float c = (float)cos(phi);
+		float s = (float)sin(phi);
+
+		outline[j].radius = ringRadius + tubeRadius * c;
+		outline[j].y = tubeRadius * s;
+		outline[j].normalRadius = c;
+		outline[j].normalY = s;
+		outline[j].v = (float)j / tubeSegments;
+	}
+
+	this->addLathe(outline, ringSegments);
+}
+
+float UVTorus::getRingRadius() { return this->ringRadius; }
+float UVTorus::getTubeRadius() { return this->tubeRadius; }
+unsigned int UVTorus::getRingSegments() { return this->ringSegments; }
+unsigned int UVTorus::getTubeSegments() { return this->tubeSegments; }
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "ProceduralMesh.h"
+
+// Torus lying in the xz plane: a tube of tubeRadius swept around a ring of ringRadius,
+// so it spans ringRadius + tubeRadius from the y axis
+class UVTorus : public ProceduralMesh {
+private:
+	float ringRadius;
+	float tubeRadius;
+	unsigned int ringSegments;
+	unsigned int tubeSegments;
+
+public:
+	UVTorus(float ringRadius, float tubeRadius, unsigned int ringSegments, unsigned int tubeSegments);
+
+	float getRingRadius();
+	float getTubeRadius();
+	unsigned int getRingSegments();
+	unsigned int getTubeSegments();
+};
@@ -0,0 +1,211 @@
+#include "VertexCacheOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+// Forsyth's scoring: the LRU cache being simulated, the fixed score of the three
+// most recent vertices (which the last triangle just used), and the bonus for
+// vertices with few triangles left so lone triangles are not left stranded
+#define SCORE_CACHE_SIZE 32
+#define LAST_TRIANGLE_SCORE 0.75f
+#define CACHE_DECAY_POWER 1.5f
+#define VALENCE_BOOST_SCALE 2.0f
+#define VALENCE_BOOST_POWER 0.5f
+
+// the score tables cover valences up to this; busier vertices use the last entry
+#define MAX_VALENCE_SCORE 64
+
+static float cachePositionScores[SCORE_CACHE_SIZE];
+static float valenceScores[MAX_VALENCE_SCORE];
+
+// meshes load on the asset workers, so the first calls can come from several threads
+static std::once_flag scoresReady;
+
+static void initScores() {
+	for (int i = 0; i < SCORE_CACHE_SIZE; i++) {
+		if (i < 3) {
+			cachePositionScores[i] = LAST_TRIANGLE_SCORE;
+		}
+		else {
+			float scaler = 1.0f / (SCORE_CACHE_SIZE - 3);
+			cachePositionScores[i] = powf(1.0f - (i - 3) * scaler, CACHE_DECAY_POWER);
+		}
+	}
+
+	valenceScores[0] = 0.0f;
+	for (int i = 1; i < MAX_VALENCE_SCORE; i++) {
+		valenceScores[i] = VALENCE_BOOST_SCALE * powf((float)i, -VALENCE_BOOST_POWER);
+	}
+}
+
+// cachePosition is -1 for a vertex outside the cache
+static float getVertexScore(int cachePosition, unsigned int remainingTriangles) {
+	if (remainingTriangles == 0) {
+		return -1.0f;
+	}
+
+	float score = cachePosition < 0 ? 0.0f : cachePositionScores[cachePosition];
+	return score + valenceScores[remainingTriangles < MAX_VALENCE_SCORE ? remainingTriangles : MAX_VALENCE_SCORE - 1];
+}
+
+float VertexCacheOptimizer::getAcmr(const unsigned int *indices, unsigned int numTriangles, unsigned int numVertices, unsigned int cacheSize) {
+	if (numTriangles == 0) {
+		return 0.0f;
+	}
+
+	// entered[v] numbers the miss that brought v in, from 1; the FIFO holds the last
+	// cacheSize misses, so v is gone once cacheSize more have followed it
+	std::vector<unsigned int> entered(numVertices, 0);
+	unsigned int misses = 0;
+
+	for (unsigned int i = 0; i < numTriangles * 3; i++) {
+		unsigned int vertex = indices[i];
+		if (entered[vertex] == 0 || misses - entered[vertex] >= cacheSize) {
+			misses++;
+			entered[vertex] = misses;
+		}
+	}
+
+	return (float)misses / numTriangles;
+}
+
+void VertexCacheOptimizer::optimizeTriangleOrder(unsigned int *indices, unsigned int numTriangles, unsigned int numVertices) {
+	if (numTriangles == 0) {
+		return;
+	}
+
+	std::call_once(scoresReady, initScores);
+
+	// triangles around each vertex
+	std::vector<unsigned int> triangleStart(numVertices + 1, 0);
+	for (unsigned int i = 0; i < numTriangles * 3; i++) {
+		triangleStart[indices[i] + 1]++;
+	}
+	for (unsigned int v = 0; v < numVertices; v++) {
+		triangleStart[v + 1] += triangleStart[v];
+	}
+	std::vector<unsigned int> vertexTriangles(numTriangles * 3);
+	std::vector<unsigned int> fill(triangleStart.begin(), triangleStart.end() - 1);
+	for (unsigned int i = 0; i < numTriangles * 3; i++) {
+		vertexTriangles[fill[indices[i]]++] = i / 3;
+	}
+
+	// triangles not yet emitted are kept at the front of each vertex's list
+	std::vector<unsigned int> remaining(numVertices);
+	std::vector<int> cachePositions(numVertices, -1);
+	std::vector<float> vertexScores(numVertices);
+	for (unsigned int v = 0; v < numVertices; v++) {
+		remaining[v] = triangleStart[v + 1] - triangleStart[v];
+		vertexScores[v] = getVertexScore(-1, remaining[v]);
+	}
+
+	std::vector<float> triangleScores(numTriangles);
+	for (unsigned int t = 0; t < numTriangles; t++) {
+		triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+	}
+
+	std::vector<bool> emitted(numTriangles, false);
+	std::vector<unsigned int> output;
+	output.reserve(numTriangles * 3);
+
+	// the cache holds three extra entries while the new triangle pushes the oldest out
+	std::vector<unsigned int> cache, nextCache;
+	cache.reserve(SCORE_CACHE_SIZE + 3);
+	nextCache.reserve(SCORE_CACHE_SIZE + 3);
+
+	unsigned int bestTriangle = 0;
+	float bestScore = triangleScores[0];
+	for (unsigned int t = 1; t < numTriangles; t++) {
+		if (triangleScores[t] > bestScore) {
+			bestScore = triangleScores[t];
+			bestTriangle = t;
+		}
+	}
+
+	// when the cache runs dry, continue from the first triangle not yet emitted
+	unsigned int scanPosition = 0;
+
+	for (unsigned int numEmitted = 0; numEmitted < numTriangles; numEmitted++) {
+		if (bestScore < 0.0f) {
+			while (emitted[scanPosition]) {
+				scanPosition++;
+			}
+			bestTriangle = scanPosition;
+		}
+
+		const unsigned int *triangle = &indices[bestTriangle * 3];
+		output.insert(output.end(), triangle, triangle + 3);
+		emitted[bestTriangle] = true;
+
+		// take the triangle off its vertices' lists of remaining triangles
+		for (int c = 0; c < 3; c++) {
+			unsigned int v = triangle[c];
+			unsigned int *list = &vertexTriangles[triangleStart[v]];
+			for (unsigned int k = 0; k < remaining[v]; k++) {
+				if (list[k] == bestTriangle) {
+					list[k] = list[remaining[v] - 1];
+					list[remaining[v] - 1] = bestTriangle;
+					break;
+				}
+			}
+			remaining[v]--;
+		}
+
+		// the triangle's vertices move to the front of the LRU cache
+		nextCache.assign(triangle, triangle + 3);
+		for (unsigned int v : cache) {
+			if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+				nextCache.push_back(v);
+			}
+		}
+		cache.swap(nextCache);
+
+		for (size_t i = 0; i < cache.size(); i++) {
+			cachePositions[cache[i]] = i < SCORE_CACHE_SIZE ? (int)i : -1;
+		}
+
+		// rescore the cached vertices and their triangles, then pick the best of those
+		for (unsigned int v : cache) {
+			float score = getVertexScore(cachePositions[v], remaining[v]);
+			float delta = score - vertexScores[v];
+			vertexScores[v] = score;
+
+			for (unsigned int k = 0; k < remaining[v]; k++) {
+				triangleScores[vertexTriangles[triangleStart[v] + k]] += delta;
+			}
+		}
+
+		bestScore = -1.0f;
+		for (unsigned int v : cache) {
+			for (unsigned int k = 0; k < remaining[v]; k++) {
+				unsigned int t = vertexTriangles[triangleStart[v] + k];
+				if (triangleScores[t] > bestScore) {
+					bestScore = triangleScores[t];
+					bestTriangle = t;
+				}
+			}
+		}
+
+		if (cache.size() > SCORE_CACHE_SIZE) {
+			cache.resize(SCORE_CACHE_SIZE);
+		}
+	}
+
+	std::copy(output.begin(), output.end(), indices);
+}
+
+unsigned int VertexCacheOptimizer::optimizeVertexOrder(unsigned int *indices, unsigned int numTriangles, unsigned int numVertices, std::vector<unsigned int> &remap) {
+	remap.assign(numVertices, numVertices);
+
+	unsigned int next = 0;
+	for (unsigned int i = 0; i < numTriangles * 3; i++) {
+		unsigned int &index = indices[i];
+		if (remap[index] == numVertices) {
+			remap[index] = next++;
+		}
+		index = remap[index];
+	}
+
+	return next;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vector>
+
+// Size of the FIFO post-transform cache getAcmr models, a typical figure for desktop GPUs
+#define VERTEX_CACHE_FIFO_SIZE 16
+
+// Reorders indexed triangle lists so the GPU transforms fewer vertices more than once
+// (Forsyth's linear-speed vertex cache optimisation), and the vertices themselves so
+// they are fetched in the order the triangles use them.
+class VertexCacheOptimizer {
+public:
+	// Average cache miss ratio: vertices transformed per triangle drawn, through a FIFO
+	// cache of cacheSize entries. 3 is no reuse at all; a regular grid approaches 0.5.
+	static float getAcmr(const unsigned int *indices, unsigned int numTriangles, unsigned int numVertices, unsigned int cacheSize = VERTEX_CACHE_FIFO_SIZE);
+
+	// Reorders the triangles in place; each keeps its winding
+	static void optimizeTriangleOrder(unsigned int *indices, unsigned int numTriangles, unsigned int numVertices);
+
+	// Renumbers the vertices in the order the triangles first use them and rewrites the
+	// indices to match. remap[old] is the new index, or numVertices for unused vertices,
+	// which should be dropped; the return value is the number of vertices still used.
+	static unsigned int optimizeVertexOrder(unsigned int *indices, unsigned int numTriangles, unsigned int numVertices, std::vector<unsigned int> &remap);
+};
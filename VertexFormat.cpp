@@ -0,0 +1,123 @@
+#include "VertexFormat.h"
+
+#include <cmath>
+#include <cstring>
+
+static inline unsigned int packSnorm10(float value) {
+	if (!(value > -1.0f)) value = -1.0f;
+	if (value > 1.0f) value = 1.0f;
+
+	int component = (int)std::floor(value * 511.0f + 0.5f);
+	return (unsigned int)component & 0x3ff;
+}
+
+// Uses the GL 4.2 / ES 3.0 signed normalized conversion, c / 511 clamped to -1
+static inline float unpackSnorm10(unsigned int bits) {
+	int component = (int)(bits & 0x3ff);
+	if (component & 0x200) {
+		component -= 0x400;
+	}
+
+	float value = component / 511.0f;
+	return value < -1.0f ? -1.0f : value;
+}
+
+unsigned int packNormal(const Vector3 normal) {
+	return packSnorm10(normal.x) | (packSnorm10(normal.y) << 10) | (packSnorm10(normal.z) << 20);
+}
+
+Vector3 unpackNormal(const unsigned int packed) {
+	Vector3 normal;
+	normal.x = unpackSnorm10(packed);
+	normal.y = unpackSnorm10(packed >> 10);
+	normal.z = unpackSnorm10(packed >> 20);
+	return normal;
+}
+
+unsigned short packHalf(const float value) {
+	unsigned int bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	unsigned int sign = (bits >> 16) & 0x8000;
+	unsigned int exponent = (bits >> 23) & 0xff;
+	unsigned int mantissa = bits & 0x7fffff;
+
+	// infinity and NaN
+	if (exponent == 0xff) {
+		return (unsigned short)(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+	}
+
+	int halfExponent = (int)exponent - 127 + 15;
+
+	// too large, round to infinity
+	if (halfExponent >= 0x1f) {
+		return (unsigned short)(sign | 0x7c00);
+	}
+
+	// subnormal half, or too small to represent at all
+	if (halfExponent <= 0) {
+		if (halfExponent < -10) {
+			return (unsigned short)sign;
+		}
+
+		mantissa |= 0x800000;
+		unsigned int shift = 14 - halfExponent;
+		unsigned int halfMantissa = mantissa >> shift;
+		unsigned int remainder = mantissa & ((1u << shift) - 1);
+		unsigned int halfway = 1u << (shift - 1);
+		if (remainder > halfway || (remainder == halfway && (halfMantissa & 1))) {
+			halfMantissa++;
+		}
+		return (unsigned short)(sign | halfMantissa);
+	}
+
+	// a carry out of the mantissa correctly bumps the exponent
+	unsigned int half = sign | ((unsigned int)halfExponent << 10) | (mantissa >> 13);
+	unsigned int remainder = mantissa & 0x1fff;
+	if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) {
+		half++;
+	}
+	return (unsigned short)half;
+}
+
+float unpackHalf(const unsigned short half) {
+	unsigned int sign = (unsigned int)(half & 0x8000) << 16;
+	unsigned int exponent = (half >> 10) & 0x1f;
+	unsigned int mantissa = half & 0x3ff;
+
+	if (exponent == 0) {
+		// zero or subnormal: mantissa * 2^-24
+		float value = mantissa * (1.0f / 16777216.0f);
+		return sign ? -value : value;
+	}
+
+	unsigned int bits;
+	if (exponent == 0x1f) {
+		bits = sign | 0x7f800000 | (mantissa << 13);
+	}
+	else {
+		bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+	}
+
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+PackedVertex packVertex(const Vertex &vertex) {
+	PackedVertex packed;
+	packed.position = vertex.position;
+	packed.normal = packNormal(vertex.normal);
+	packed.textureCoord[0] = packHalf(vertex.textureCoord.u);
+	packed.textureCoord[1] = packHalf(vertex.textureCoord.v);
+	return packed;
+}
+
+Vertex unpackVertex(const PackedVertex &packed) {
+	Vertex vertex;
+	vertex.position = packed.position;
+	vertex.normal = unpackNormal(packed.normal);
+	vertex.textureCoord.u = unpackHalf(packed.textureCoord[0]);
+	vertex.textureCoord.v = unpackHalf(packed.textureCoord[1]);
+	return vertex;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+struct Vector3 {
+	float x;
+	float y;
+	float z;
+};
+
+struct Vector2 {
+	float u;
+	float v;
+};
+
+// Vertex layouts for a single interleaved vertex buffer
+enum VertexLayout {
+	// Vertex: 32 bytes, all floats
+	VERTEX_LAYOUT_FLOAT,
+	// PackedVertex: 20 bytes, normal as GL_INT_2_10_10_10_REV, uv as GL_HALF_FLOAT
+	VERTEX_LAYOUT_PACKED
+};
+
+struct Vertex {
+	Vector3 position;
+	Vector3 normal;
+	Vector2 textureCoord;
+};
+
+struct PackedVertex {
+	Vector3 position;
+	unsigned int normal;
+	unsigned short textureCoord[2];
+};
+
+// Signed normalized 10:10:10:2, x in the low bits; w is left at zero
+unsigned int packNormal(const Vector3 normal);
+Vector3 unpackNormal(const unsigned int packed);
+
+// IEEE 754 binary16, round to nearest even
+unsigned short packHalf(const float value);
+float unpackHalf(const unsigned short half);
+
+PackedVertex packVertex(const Vertex &vertex);
+Vertex unpackVertex(const PackedVertex &packed);
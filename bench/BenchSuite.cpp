@@ -0,0 +1,504 @@
+// Repeatable microbenchmarks of the loader, animation and render hot paths, written
+// as JSON so results can be tracked from build to build. Run from the project root
+// (make -f Makefile.Unix bench) so meshes/ and textures/ resolve.
+//
+//   ./bench_suite [-iterations N] [-frames N] [-main ./main] [-o results.json]
+//
+// The headless scene run needs ./main built with -headless support (and EGL); when it
+// cannot run, that entry is reported as skipped rather than failing the suite.
+
+#include "../ObjMesh.h"
+#include "../MeshSimplifier.h"
+#include "../VertexCacheOptimizer.h"
+#include "../MipmapGenerator.h"
+#include "../TextureCompressor.h"
+#include "../UVCylinder.h"
+#include "../UVTorus.h"
+#include "../UVSphere.h"
+#include "../Capsule.h"
+#include "../Animation.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "../apis/stb_image.h"
+
+extern "C" {
+#include <soil/src/image_DXT.h>
+}
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <unistd.h>
+
+struct BenchResult {
+	std::string name;
+	unsigned int iterations;
+	double minMs;
+	double medianMs;
+	double meanMs;
+	// work done per iteration, reported as a rate when there is a unit for it
+	double itemsPerIteration;
+	std::string itemUnit;
+	std::string skipped;
+};
+
+// Times fn once untimed (to warm caches) and then iterations times
+static BenchResult runBench(const std::string name, unsigned int iterations, std::function<void()> fn) {
+	std::vector<double> times;
+
+	// benchmarked code such as ObjMesh::load reports what it is doing; keep that out of the timings
+	std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+
+	fn();
+	for (unsigned int i = 0; i < iterations; i++) {
+		auto start = std::chrono::high_resolution_clock::now();
+		fn();
+		times.push_back(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+	}
+
+	std::cout.rdbuf(coutBuffer);
+	std::cout.clear();
+
+	std::sort(times.begin(), times.end());
+
+	BenchResult result;
+	result.name = name;
+	result.iterations = iterations;
+	result.minMs = times.front();
+	result.medianMs = times[times.size() / 2];
+	result.meanMs = 0.0;
+	for (double time : times) {
+		result.meanMs += time;
+	}
+	result.meanMs /= times.size();
+	result.itemsPerIteration = 0.0;
+
+	std::cerr << "  " << name << ": median " << result.medianMs << " ms" << std::endl;
+	return result;
+}
+
+static BenchResult skippedBench(const std::string name, const std::string reason) {
+	BenchResult result;
+	result.name = name;
+	result.iterations = 0;
+	result.minMs = result.medianMs = result.meanMs = 0.0;
+	result.itemsPerIteration = 0.0;
+	result.skipped = reason;
+
+	std::cerr << "  " << name << ": skipped, " << reason << std::endl;
+	return result;
+}
+
+static std::vector<std::string> listMeshes(const std::string directory) {
+	std::vector<std::string> filenames;
+
+	DIR* dir = opendir(directory.c_str());
+	if (dir == nullptr) {
+		return filenames;
+	}
+
+	while (dirent* entry = readdir(dir)) {
+		std::string name = entry->d_name;
+		if (name.size() > 4 && name.compare(name.size() - 4, 4, ".obj") == 0) {
+			filenames.push_back(directory + "/" + name);
+		}
+	}
+	closedir(dir);
+
+	std::sort(filenames.begin(), filenames.end());
+	return filenames;
+}
+
+static void benchLoader(std::vector<BenchResult> &results, unsigned int iterations) {
+	for (const std::string &filename : listMeshes("meshes")) {
+		ObjMesh probe;
+		std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+		probe.load(filename, true, true);
+		std::cout.rdbuf(coutBuffer);
+
+		// the binary cache is off by default, so every load parses the text
+		BenchResult result = runBench("objmesh_load/" + filename, iterations, [&filename]() {
+			ObjMesh mesh;
+			mesh.load(filename, true, true);
+		});
+		result.itemsPerIteration = probe.getNumTriangles();
+		result.itemUnit = "triangles";
+		results.push_back(result);
+	}
+}
+
+static void benchCylinder(std::vector<BenchResult> &results, unsigned int iterations) {
+	const unsigned int segmentCounts[] = { 16, 64, 256, 1024 };
+	const std::string filename = "bench_cylinder.obj";
+
+	for (unsigned int numSegments : segmentCounts) {
+		BenchResult generated = runBench("uvcylinder_generate/" + std::to_string(numSegments), iterations, [numSegments]() {
+			UVCylinder cylinder(1.0f, numSegments);
+		});
+		generated.itemsPerIteration = numSegments;
+		generated.itemUnit = "segments";
+		results.push_back(generated);
+
+		BenchResult result = runBench("uvcylinder_save/" + std::to_string(numSegments), iterations, [numSegments, &filename]() {
+			UVCylinder cylinder(1.0f, numSegments);
+			cylinder.save(filename);
+		});
+		result.itemsPerIteration = numSegments;
+		result.itemUnit = "segments";
+		results.push_back(result);
+	}
+
+	remove(filename.c_str());
+}
+
+// A million triangle torus, the scale the procedural generators are meant to rebuild interactively
+static void benchTorus(std::vector<BenchResult> &results, unsigned int iterations) {
+	BenchResult result = runBench("uvtorus_generate/1000x500", iterations, []() {
+		UVTorus torus(1.0f, 0.3f, 1000, 500);
+	});
+	result.itemsPerIteration = 1000 * 500 * 2;
+	result.itemUnit = "triangles";
+	results.push_back(result);
+}
+
+// The other lathed primitives at about the same size; the poles are fans, so a little under
+static void benchSphere(std::vector<BenchResult> &results, unsigned int iterations) {
+	BenchResult result = runBench("uvsphere_generate/1000x500", iterations, []() {
+		UVSphere sphere(1.0f, 1000, 500);
+	});
+	result.itemsPerIteration = 1000 * (500 - 1) * 2;
+	result.itemUnit = "triangles";
+	results.push_back(result);
+}
+
+static void benchCapsule(std::vector<BenchResult> &results, unsigned int iterations) {
+	BenchResult result = runBench("capsule_generate/1000x250", iterations, []() {
+		Capsule capsule(0.5f, 1.0f, 1000, 250);
+	});
+	result.itemsPerIteration = 1000 * 250 * 4;
+	result.itemUnit = "triangles";
+	results.push_back(result);
+}
+
+// The skybox down to the 2000 triangles meshconv -simplify would ship it at
+static void benchSimplify(std::vector<BenchResult> &results, unsigned int iterations) {
+	const std::string filename = "meshes/skybox.obj";
+
+	ObjMesh mesh;
+	std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+	mesh.load(filename, true, true);
+	std::cout.rdbuf(coutBuffer);
+
+	if (mesh.getNumTriangles() == 0) {
+		results.push_back(skippedBench("mesh_simplify/" + filename, "cannot load the file"));
+		return;
+	}
+
+	BenchResult result = runBench("mesh_simplify/" + filename + "/2000", iterations, [&mesh]() {
+		MeshSimplifier simplifier(mesh);
+		simplifier.simplify(2000);
+	});
+	result.itemsPerIteration = mesh.getNumTriangles();
+	result.itemUnit = "triangles";
+	results.push_back(result);
+}
+
+// Triangle and vertex reordering of the skybox as loaded, before ObjMesh::optimize
+static void benchVertexCache(std::vector<BenchResult> &results, unsigned int iterations) {
+	const std::string filename = "meshes/skybox.obj";
+
+	ObjMesh mesh;
+	std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+	mesh.load(filename, true, true);
+	std::cout.rdbuf(coutBuffer);
+
+	if (mesh.getNumTriangles() == 0) {
+		results.push_back(skippedBench("vertex_cache_optimize/" + filename, "cannot load the file"));
+		return;
+	}
+
+	std::vector<unsigned int> indices;
+	std::vector<unsigned int> remap;
+	BenchResult result = runBench("vertex_cache_optimize/" + filename, iterations, [&mesh, &indices, &remap]() {
+		indices.assign(mesh.getTriangleIndices(), mesh.getTriangleIndices() + mesh.getNumTriangles() * 3);
+		VertexCacheOptimizer::optimizeTriangleOrder(indices.data(), mesh.getNumTriangles(), mesh.getNumIndexedVertices());
+		VertexCacheOptimizer::optimizeVertexOrder(indices.data(), mesh.getNumTriangles(), mesh.getNumIndexedVertices(), remap);
+	});
+	result.itemsPerIteration = mesh.getNumTriangles();
+	result.itemUnit = "triangles";
+	results.push_back(result);
+}
+
+// The decode half of createTexture in main.cpp; the GL upload is covered by the scene run
+static void benchTextureDecode(std::vector<BenchResult> &results, unsigned int iterations) {
+	const std::string filename = "textures/stars.jpeg";
+
+	int width = 0, height = 0, channels = 0;
+	unsigned char* probe = stbi_load(filename.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+	if (probe == nullptr) {
+		results.push_back(skippedBench("texture_decode/" + filename, "cannot decode the file"));
+		return;
+	}
+	stbi_image_free(probe);
+
+	BenchResult result = runBench("texture_decode/" + filename, iterations, [&filename]() {
+		int w, h, c;
+		unsigned char* bitmap = stbi_load(filename.c_str(), &w, &h, &c, STBI_rgb_alpha);
+		stbi_image_free(bitmap);
+	});
+	result.itemsPerIteration = (double)width * height;
+	result.itemUnit = "pixels";
+	results.push_back(result);
+}
+
+// The CPU mip chain, with each filter, then DXT compression of it with and without
+// SIMD, and reading it back from the .dds cache as later runs do instead of decoding
+static void benchTextureCompress(std::vector<BenchResult> &results, unsigned int iterations) {
+	const std::string filename = "textures/stars.jpeg";
+
+	int width = 0, height = 0, channels = 0;
+	unsigned char* pixels = stbi_load(filename.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+	if (pixels == nullptr) {
+		results.push_back(skippedBench("mipmap_box/" + filename, "cannot decode the file"));
+		results.push_back(skippedBench("mipmap_kaiser/" + filename, "cannot decode the file"));
+		results.push_back(skippedBench("texture_compress/" + filename, "cannot decode the file"));
+		results.push_back(skippedBench("texture_dds_read/" + filename, "cannot decode the file"));
+		return;
+	}
+
+	std::vector<MipLevel> mips;
+	const int filters[] = { MIPMAP_FILTER_BOX, MIPMAP_FILTER_KAISER };
+	for (int filter : filters) {
+		BenchResult result = runBench(std::string("mipmap_") + MipmapGenerator::getFilterName(filter) + "/" + filename, iterations, [pixels, width, height, filter, &mips]() {
+			mips.clear();
+			MipmapGenerator::generate(pixels, width, height, filter, true, mips);
+		});
+		result.itemsPerIteration = (double)width * height;
+		result.itemUnit = "pixels";
+		results.push_back(result);
+	}
+
+	CompressedImage image;
+	BenchResult compressed = runBench("texture_compress/" + filename, iterations, [pixels, width, height, &mips, &image]() {
+		TextureCompressor::compress(pixels, width, height, MIPMAP_FILTER_KAISER, mips, image);
+	});
+	compressed.itemsPerIteration = (double)width * height;
+	compressed.itemUnit = "pixels";
+	results.push_back(compressed);
+
+	// the same with image_DXT's SIMD block encoder off
+	int simdEnabled = DXT_set_SIMD_enabled(0);
+	CompressedImage scalar;
+	BenchResult scalarCompressed = runBench("texture_compress_scalar/" + filename, iterations, [pixels, width, height, &mips, &scalar]() {
+		TextureCompressor::compress(pixels, width, height, MIPMAP_FILTER_KAISER, mips, scalar);
+	});
+	DXT_set_SIMD_enabled(simdEnabled);
+	scalarCompressed.itemsPerIteration = (double)width * height;
+	scalarCompressed.itemUnit = "pixels";
+	results.push_back(scalarCompressed);
+	stbi_image_free(pixels);
+
+	const std::string cacheFilename = "bench_texture.dds";
+	if (!TextureCompressor::writeDds(cacheFilename, filename, image)) {
+		results.push_back(skippedBench("texture_dds_read/" + filename, "cannot write " + cacheFilename));
+		return;
+	}
+
+	BenchResult read = runBench("texture_dds_read/" + filename, iterations, [&filename, &cacheFilename]() {
+		CompressedImage cached;
+		TextureCompressor::readDds(cacheFilename, filename, MIPMAP_FILTER_KAISER, cached);
+	});
+	read.itemsPerIteration = (double)width * height;
+	read.itemUnit = "pixels";
+	results.push_back(read);
+	remove(cacheFilename.c_str());
+}
+
+// Steps a disk move (lift, traverse, drop) at the 10 ms simulation step until it ends, over and over
+static void benchAnimation(std::vector<BenchResult> &results, unsigned int iterations) {
+	const unsigned int numUpdates = 1000000;
+
+	BenchResult result = runBench("animation_update", iterations, [numUpdates]() {
+		Animation animation({
+			Frame(glm::vec3(0.0f, -1.8f, 0.0f), 0),
+			Frame(glm::vec3(0.0f, 5.0f, 0.0f), 3000),
+			Frame(glm::vec3(0.0f, 5.0f, 5.0f), 1500),
+			Frame(glm::vec3(0.0f, -1.8f, 5.0f), 3000),
+			});
+
+		unsigned long long time = 0;
+		float checksum = 0.0f;
+		animation.Reset(time);
+		for (unsigned int i = 0; i < numUpdates; i++) {
+			glm::mat4 transform(1.0f);
+			if (!animation.Update(time, transform)) {
+				animation.Reset(time);
+			}
+			checksum += transform[3].y;
+			time += 10;
+		}
+
+		// keep the loop from being optimized away
+		if (checksum == 1.0f) {
+			std::cerr << "";
+		}
+	});
+	result.itemsPerIteration = numUpdates;
+	result.itemUnit = "updates";
+	results.push_back(result);
+}
+
+// Runs the whole scene offscreen through main -headless and reads back its frame rate
+static void benchScene(std::vector<BenchResult> &results, const std::string mainPath, unsigned int numFrames, unsigned int iterations) {
+	const std::string name = "headless_scene/" + std::to_string(numFrames) + "_frames";
+
+	if (access(mainPath.c_str(), X_OK) != 0) {
+		results.push_back(skippedBench(name, mainPath + " is not built"));
+		return;
+	}
+
+	std::string command = mainPath + " -headless " + std::to_string(numFrames) + " 2>&1";
+	std::vector<double> times;
+
+	for (unsigned int i = 0; i < iterations; i++) {
+		FILE* pipe = popen(command.c_str(), "r");
+		if (pipe == nullptr) {
+			break;
+		}
+
+		// "Rendered N frames in X ms (Y fps)"
+		double elapsedMs = -1.0;
+		char line[512];
+		while (fgets(line, sizeof(line), pipe) != nullptr) {
+			unsigned int frames;
+			double ms;
+			if (sscanf(line, "Rendered %u frames in %lf ms", &frames, &ms) == 2) {
+				elapsedMs = ms;
+			}
+		}
+
+		if (pclose(pipe) != 0 || elapsedMs < 0.0) {
+			break;
+		}
+		times.push_back(elapsedMs);
+	}
+
+	if (times.size() != iterations) {
+		results.push_back(skippedBench(name, mainPath + " -headless did not run"));
+		return;
+	}
+
+	std::sort(times.begin(), times.end());
+
+	BenchResult result;
+	result.name = name;
+	result.iterations = iterations;
+	result.minMs = times.front();
+	result.medianMs = times[times.size() / 2];
+	result.meanMs = 0.0;
+	for (double time : times) {
+		result.meanMs += time;
+	}
+	result.meanMs /= times.size();
+	result.itemsPerIteration = numFrames;
+	result.itemUnit = "frames";
+	results.push_back(result);
+
+	std::cerr << "  " << name << ": median " << result.medianMs << " ms" << std::endl;
+}
+
+static std::string toJson(const std::vector<BenchResult> &results) {
+	std::ostringstream out;
+	out << "{\n  \"timestamp\": " << (long long)time(nullptr) << ",\n  \"results\": [\n";
+
+	for (size_t i = 0; i < results.size(); i++) {
+		const BenchResult &result = results[i];
+		out << "    {\"name\": \"" << result.name << "\"";
+
+		if (!result.skipped.empty()) {
+			out << ", \"skipped\": \"" << result.skipped << "\"";
+		}
+		else {
+			out << ", \"iterations\": " << result.iterations
+				<< ", \"min_ms\": " << result.minMs
+				<< ", \"median_ms\": " << result.medianMs
+				<< ", \"mean_ms\": " << result.meanMs;
+
+			if (!result.itemUnit.empty() && result.medianMs > 0.0) {
+				out << ", \"" << result.itemUnit << "_per_sec\": " << result.itemsPerIteration / (result.medianMs / 1000.0);
+			}
+		}
+
+		out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+	}
+
+	out << "  ]\n}\n";
+	return out.str();
+}
+
+int main(int argc, char** argv) {
+	unsigned int iterations = 10;
+	unsigned int numFrames = 300;
+	std::string mainPath = "./main";
+	std::string outputFilename;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-iterations") == 0 && i + 1 < argc) {
+			iterations = std::max(atoi(argv[++i]), 1);
+		}
+		else if (strcmp(argv[i], "-frames") == 0 && i + 1 < argc) {
+			numFrames = std::max(atoi(argv[++i]), 1);
+		}
+		else if (strcmp(argv[i], "-main") == 0 && i + 1 < argc) {
+			mainPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+			outputFilename = argv[++i];
+		}
+		else {
+			std::cerr << "Usage: " << argv[0] << " [-iterations N] [-frames N] [-main ./main] [-o results.json]" << std::endl;
+			return 1;
+		}
+	}
+
+	std::vector<BenchResult> results;
+	benchLoader(results, iterations);
+	benchCylinder(results, iterations);
+	benchTorus(results, iterations);
+	benchSphere(results, iterations);
+	benchCapsule(results, iterations);
+	benchSimplify(results, iterations);
+	benchVertexCache(results, iterations);
+	benchTextureDecode(results, iterations);
+	benchTextureCompress(results, iterations);
+	benchAnimation(results, iterations);
+	// each run is a whole process with its own startup, so fewer of them
+	benchScene(results, mainPath, numFrames, std::max(iterations / 5, 1u));
+
+	std::string json = toJson(results);
+	if (outputFilename.empty()) {
+		std::cout << json;
+	}
+	else {
+		std::ofstream fileOut(outputFilename.c_str(), std::ios::trunc);
+		fileOut << json;
+		if (!fileOut) {
+			std::cerr << "Could not write " << outputFilename << std::endl;
+			return 1;
+		}
+		std::cerr << "Wrote " << outputFilename << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,109 @@
+// Generates every move of an N disk solution with HanoiSolver, both by random access
+// (getMove) and by stepping the pegs (nextMove), and times seek() to arbitrary moves.
+// Smaller solutions are first checked against the rules of the puzzle.
+//
+//   ./hanoi_bench [disks]        (default 30, i.e. 2^30 - 1 moves)
+
+#include "../HanoiSolver.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+static double secondsSince(std::chrono::high_resolution_clock::time_point start) {
+	return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// Plays the whole solution, checking no disk lands on a smaller one, that it ends on
+// peg 2 and that seek() agrees with the pegs after every move
+static bool verify(unsigned int numDisks) {
+	HanoiSolver solver(numDisks);
+	HanoiSolver seeker(numDisks);
+	HanoiMove move;
+
+	while (true) {
+		std::vector<unsigned int> before[3];
+		for (unsigned int peg = 0; peg < 3; peg++) {
+			before[peg] = solver.getPegDisks(peg);
+		}
+
+		if (!solver.nextMove(move)) {
+			break;
+		}
+
+		if (before[move.from].empty() || before[move.from].back() != move.disk ||
+			(!before[move.to].empty() && before[move.to].back() < move.disk)) {
+			return false;
+		}
+
+		seeker.seek(solver.getMovesMade());
+		for (unsigned int peg = 0; peg < 3; peg++) {
+			if (seeker.getPegDisks(peg) != solver.getPegDisks(peg)) {
+				return false;
+			}
+		}
+	}
+
+	return solver.getMovesMade() == solver.getNumMoves() && solver.getPegHeight(2) == numDisks;
+}
+
+int main(int argc, char** argv) {
+	unsigned int numDisks = argc > 1 ? atoi(argv[1]) : 30;
+	if (numDisks < 1 || numDisks > 63) {
+		std::cerr << "Usage: " << argv[0] << " [disks 1-63]" << std::endl;
+		return 1;
+	}
+
+	for (unsigned int n = 1; n <= 16; n++) {
+		if (!verify(n)) {
+			std::cerr << "  solution for " << n << " disks is wrong" << std::endl;
+			return 1;
+		}
+	}
+	std::cout << "  solutions for 1-16 disks verified" << std::endl;
+
+	unsigned long long numMoves = (1ULL << numDisks) - 1;
+
+	// sum the moves so the loop cannot be optimized away
+	auto start = std::chrono::high_resolution_clock::now();
+	unsigned long long checksum = 0;
+	for (unsigned long long k = 0; k < numMoves; k++) {
+		HanoiMove move = HanoiSolver::getMove(numDisks, k);
+		checksum += move.disk + move.from * 3 + move.to;
+	}
+	double randomAccessTime = secondsSince(start);
+
+	HanoiSolver solver(numDisks);
+	HanoiMove move;
+	start = std::chrono::high_resolution_clock::now();
+	unsigned long long sequentialChecksum = 0;
+	while (solver.nextMove(move)) {
+		sequentialChecksum += move.disk + move.from * 3 + move.to;
+	}
+	double sequentialTime = secondsSince(start);
+
+	if (checksum != sequentialChecksum || solver.getPegHeight(2) != numDisks) {
+		std::cerr << "  getMove and nextMove disagree" << std::endl;
+		return 1;
+	}
+
+	const unsigned int numSeeks = 1000000;
+	unsigned long long seekTarget = 0;
+	unsigned long long seekChecksum = 0;
+	start = std::chrono::high_resolution_clock::now();
+	for (unsigned int i = 0; i < numSeeks; i++) {
+		// a cheap LCG spreads the targets over the whole solution
+		seekTarget = seekTarget * 6364136223846793005ULL + 1442695040888963407ULL;
+		solver.seek(seekTarget % (numMoves + 1));
+		seekChecksum += solver.getPegHeight(0);
+	}
+	double seekTime = secondsSince(start);
+
+	std::cout << "  " << numDisks << " disks, " << numMoves << " moves (checksum " << checksum << ")" << std::endl;
+	std::cout << "  getMove:  " << randomAccessTime << " s, " << numMoves / randomAccessTime / 1e6 << " million moves/sec" << std::endl;
+	std::cout << "  nextMove: " << sequentialTime << " s, " << numMoves / sequentialTime / 1e6 << " million moves/sec" << std::endl;
+	std::cout << "  seek:     " << seekTime * 1e9 / numSeeks << " ns per seek (" << seekChecksum << ")" << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,156 @@
+// Compares the stream, mapped and parallel ObjMesh parsers: time per load,
+// lines/sec and heap allocations per load. Run from the project root so meshes/ resolves.
+//
+//   ./objmesh_bench [iterations] [file.obj ...]
+
+#include "../ObjMesh.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+static unsigned long long allocationCount = 0;
+
+void* operator new(std::size_t size) {
+	allocationCount++;
+	void* p = std::malloc(size ? size : 1);
+	if (p == nullptr) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+struct LoadResult {
+	double milliseconds;
+	unsigned long long allocations;
+};
+
+static unsigned long long countLines(const std::string &filename) {
+	std::ifstream fileIn(filename, std::ios::binary);
+	unsigned long long lines = 0;
+	char buffer[1 << 16];
+	while (fileIn.read(buffer, sizeof(buffer)) || fileIn.gcount() > 0) {
+		for (std::streamsize i = 0; i < fileIn.gcount(); i++) {
+			if (buffer[i] == '\n') lines++;
+		}
+	}
+	return lines;
+}
+
+static LoadResult timeLoad(const std::string &filename, ObjMesh::Parser parser, ObjMesh &mesh) {
+	// ObjMesh::load reports every file it loads; keep that out of the timings
+	std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+
+	mesh.setParser(parser);
+
+	unsigned long long allocationsBefore = allocationCount;
+	auto start = std::chrono::high_resolution_clock::now();
+	mesh.load(filename, true, true);
+	auto end = std::chrono::high_resolution_clock::now();
+
+	std::cout.rdbuf(coutBuffer);
+	std::cout.clear();
+
+	LoadResult result;
+	result.milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+	result.allocations = allocationCount - allocationsBefore;
+	return result;
+}
+
+template <typename T>
+static bool sameData(const T* a, const T* b, unsigned int count) {
+	return count == 0 || std::memcmp(a, b, sizeof(T) * count) == 0;
+}
+
+static bool sameOutput(ObjMesh &a, ObjMesh &b) {
+	unsigned int n = a.getNumIndexedVertices();
+	return n == b.getNumIndexedVertices() &&
+		a.getNumVertices() == b.getNumVertices() &&
+		a.getNumTriangles() == b.getNumTriangles() &&
+		sameData(a.getIndexedPositions(), b.getIndexedPositions(), n) &&
+		sameData(a.getIndexedTextureCoords(), b.getIndexedTextureCoords(), n) &&
+		sameData(a.getIndexedNormals(), b.getIndexedNormals(), n) &&
+		sameData(a.getTriangleIndices(), b.getTriangleIndices(), a.getNumTriangles() * 3);
+}
+
+int main(int argc, char** argv) {
+	int iterations = 10;
+	std::vector<std::string> filenames;
+
+	for (int i = 1; i < argc; i++) {
+		int value = std::atoi(argv[i]);
+		if (value > 0) {
+			iterations = value;
+		}
+		else {
+			filenames.push_back(argv[i]);
+		}
+	}
+	if (filenames.empty()) {
+		filenames.push_back("meshes/skybox.obj");
+		filenames.push_back("meshes/torus.obj");
+	}
+
+	bool allIdentical = true;
+
+	for (const std::string &filename : filenames) {
+		unsigned long long lines = countLines(filename);
+		std::cout << filename << " (" << lines << " lines, " << iterations << " iterations)" << std::endl;
+
+		const ObjMesh::Parser parsers[] = { ObjMesh::PARSER_STREAM, ObjMesh::PARSER_MAPPED, ObjMesh::PARSER_PARALLEL };
+		const char* names[] = { "stream", "mapped", "parallel" };
+		const int numParsers = 3;
+		double bestTimes[numParsers];
+
+		for (int p = 0; p < numParsers; p++) {
+			double best = 1e30;
+			double total = 0.0;
+			unsigned long long allocations = 0;
+
+			for (int i = 0; i < iterations; i++) {
+				ObjMesh mesh;
+				LoadResult result = timeLoad(filename, parsers[p], mesh);
+				if (result.milliseconds < best) best = result.milliseconds;
+				total += result.milliseconds;
+				allocations = result.allocations;
+			}
+
+			bestTimes[p] = best;
+			std::cout << "  " << names[p]
+				<< ": best " << best << " ms, avg " << total / iterations << " ms, "
+				<< (unsigned long long)(lines / (best / 1000.0)) << " lines/sec, "
+				<< allocations << " allocations/load";
+			if (p > 0) {
+				std::cout << ", " << bestTimes[0] / best << "x stream";
+			}
+			std::cout << std::endl;
+		}
+
+		ObjMesh streamMesh, mappedMesh, parallelMesh;
+		timeLoad(filename, ObjMesh::PARSER_STREAM, streamMesh);
+		timeLoad(filename, ObjMesh::PARSER_MAPPED, mappedMesh);
+		timeLoad(filename, ObjMesh::PARSER_PARALLEL, parallelMesh);
+		bool identical = sameOutput(streamMesh, mappedMesh) && sameOutput(streamMesh, parallelMesh);
+		allIdentical = allIdentical && identical;
+
+		std::cout << "  output " << (identical ? "identical" : "DIFFERS") << " across parsers" << std::endl;
+		std::cout << "  " << mappedMesh.getNumVertices() << " face vertices welded to "
+			<< mappedMesh.getNumIndexedVertices() << " ("
+			<< (double)mappedMesh.getNumVertices() / mappedMesh.getNumIndexedVertices() << "x fewer)" << std::endl;
+	}
+
+	return allIdentical ? 0 : 1;
+}
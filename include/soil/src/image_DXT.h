@@ -45,6 +45,54 @@ convert_image_to_DXT5
     int *out_size
 );
 
+/**
+	Compress only the 4x4 block rows [first_block_row, first_block_row + num_block_rows)
+	of an image, into compressed, which must hold ((width+3)/4) * num_block_rows
+	blocks (8 bytes each for DXT1, 16 for DXT5).  Every block depends only on its own
+	pixels, so rows compressed separately (e.g. on different threads) concatenate to
+	exactly what convert_image_to_DXT1/DXT5 return for the whole image.
+	\return 0 if failed, otherwise returns 1
+**/
+int
+convert_image_rows_to_DXT1
+(
+    const unsigned char *const uncompressed,
+    int width, int height, int channels,
+    int first_block_row, int num_block_rows,
+    unsigned char *compressed
+);
+
+int
+convert_image_rows_to_DXT5
+(
+    const unsigned char *const uncompressed,
+    int width, int height, int channels,
+    int first_block_row, int num_block_rows,
+    unsigned char *compressed
+);
+
+/**
+	The SIMD block encoder compiled in: 0 for none, 1 for SSE2,
+	2 for AVX2 (when built with -mavx2).
+**/
+int
+DXT_SIMD_level
+(
+    void
+);
+
+/**
+	Turn the SIMD block encoder on or off (it is on when compiled in),
+	e.g. to compare it against the scalar one, which gives the same
+	output.  Not thread safe: call it while nothing is compressing.
+	\return the previous setting
+**/
+int
+DXT_set_SIMD_enabled
+(
+    int enabled
+);
+
 /**	A bunch of DirectDraw Surface structures and flags **/
 typedef struct
 {
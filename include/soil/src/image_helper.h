@@ -43,6 +43,35 @@ int
 		int block_size_x, int block_size_y
 	);
 
+/**	filters for mipmap_image_filtered	**/
+#define MIPMAP_FILTER_BOX	0
+#define MIPMAP_FILTER_KAISER	1
+
+/**
+	This function downscales an image to the next MIPmap level,
+	half the size (rounded down, at least 1) in each direction,
+	in linear light: with srgb set, the color channels are decoded
+	from sRGB before filtering and encoded again after, while alpha
+	(the 2nd or 4th channel) is always linear.  Any size works.
+
+	MIPMAP_FILTER_BOX averages the area each pixel covers,
+	MIPMAP_FILTER_KAISER is a Kaiser windowed sinc, which keeps
+	more detail (edges are clamped).
+
+	Only rows [first_row, first_row + num_rows) of the result are
+	written, so a level can be split across threads.
+	\return 0 if failed, otherwise returns 1
+**/
+int
+	mipmap_image_filtered
+	(
+		const unsigned char* const orig,
+		int width, int height, int channels,
+		unsigned char* resampled,
+		int filter, int srgb,
+		int first_row, int num_rows
+	);
+
 /**
 	This function takes the RGB components of the image
 	and scales each channel from [0,255] to [16,235].
@@ -1,11 +1,25 @@
 #include "ShaderProgram.h"
-#include "ObjMesh.h"
 #include "UVCylinder.h"
+#include "UVTorus.h"
+#include "Box.h"
+#include "VertexFormat.h"
+#include "Animation.h"
+#include "HanoiSolver.h"
+#include "SimulationClock.h"
+#include "HeadlessContext.h"
+#include "Profiler.h"
+#include "AssetManager.h"
+#include "TextureCache.h"
+#include "MipmapGenerator.h"
 
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <chrono>
 #include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
 #include <map>
 #include <GL/glew.h>
 #include <soil/src/SOIL.h>
@@ -15,6 +29,9 @@
 
 #ifdef __APPLE__
 #  include <GLUT/glut.h>
+#elif defined(__linux__)
+// freeglut, as Linux ships it, for glutCloseFunc
+#  include <GL/freeglut.h>
 #else
 #  include <GL/glut.h>
 #endif
@@ -32,115 +49,119 @@ float lightRotation = 0.0f;
 
 GLuint programId;
 glm::vec4 lightPosDir;
-GLuint skyboxTexture = GL_NONE;
 
-struct MeshBuffers
+// Shader variable locations, looked up once after the program is linked
+struct ShaderLocations
 {
-	GLuint positions;
-	GLuint textureCoords;
-	GLuint normals;
-	GLuint colours;
-
-	GLuint index;
+	GLint viewProjection;
+	GLint lightPosDir;
+	GLint textured;
+	GLint texture;
+
+	GLint position;
+	GLint textureCoords;
+	GLint normal;
+	GLint instanceModel; // a mat4, so it spans four consecutive locations
+	GLint instanceColor;
 };
+ShaderLocations locations;
 
-float lerp(float startValue, float endValue, float t) {
-	return startValue * (1.0f - t) + endValue * t;
-}
-
-glm::vec3 lerp(glm::vec3 start, glm::vec3 end, float t) {
-	return glm::vec3(lerp(start.x, end.x, t), lerp(start.y, end.y, t), lerp(start.z, end.z, t));
-}
-
-struct Frame {
-	glm::vec3 position;
-	unsigned int duration;
-
-	Frame(glm::vec3 p, unsigned int d) {
-		position = p;
-		duration = d;
-	}
+// The same for the skybox's shader
+struct SkyboxShaderLocations
+{
+	GLint modelView;
+	GLint projection;
+	GLint textureSampler;
+	GLint position;
 };
+GLuint skyboxProgramId;
+SkyboxShaderLocations skyboxLocations;
 
-class Animation {
-	std::vector<Frame> frames;
-	unsigned int lastFrame;
-	unsigned int currentFrame;
-	unsigned int frameSwitchTime;
-	bool animating;
+// GL calls issued by render(), counted through COUNT_GL
+unsigned int glCallsThisFrame = 0;
+unsigned int glCallsLastFrame = 0;
+#define COUNT_GL(call) (glCallsThisFrame++, call)
 
-public:
-	Animation(std::vector<Frame> fv) {
-		frames = fv;
-		lastFrame = 0;
-		currentFrame = 1;
-		frameSwitchTime = 0.0f;
-		animating = true;
-	}
+// Vertices (indices) submitted by render(), to see what level of detail saves
+unsigned long long verticesThisFrame = 0;
+unsigned long long verticesLastFrame = 0;
 
-	void AddFrame(Frame frame) {
-		frames.push_back(frame);
-	}
-
-	bool Update(unsigned int time, glm::mat4 &outTransform) {
-		if (!animating) return false;
-		if (frames.size() < 2) return false; // frame[0] == initial position, frame[1..n] == transitions
+Profiler profiler;
+bool showProfile = false;
+int lastProfileShownMs = 0;
 
-		// Get frames
-		Frame last = frames[lastFrame];
-		Frame current = frames[currentFrame];
-
-		unsigned int delta = time - frameSwitchTime;
-		if (delta > current.duration) {
-			// Get next frame
-			if (currentFrame + 1 > frames.size() - 1) {
-				animating = false;
-				return false;
-			}
+GLuint skyboxTexture = GL_NONE;
 
-			// Set new frames
-			last = frames[++lastFrame];
-			current = frames[++currentFrame];
+// Every texture a mesh uses comes from here, one reference per mesh
+TextureCache textures;
 
-			// Update time since frame was last changed
-			frameSwitchTime = time;
-		}
+struct MeshBuffers
+{
+	// interleaved positions, normals and texture coordinates, see VertexFormat.h
+	GLuint vertices;
+	VertexLayout layout;
+	// attribute layout and index buffer binding, recorded once in createGeometry
+	GLuint vertexArray;
+	GLuint colours;
 
-		float p = glm::min((float)delta / (float)current.duration, 1.0f);
+	GLuint index;
 
-		// Apply transformation
-		outTransform = glm::translate(outTransform, lerp(last.position, current.position, p));
+	// per-instance transforms and colours, refilled every frame by render()
+	GLuint instances;
+	unsigned int instanceCapacity;
+};
 
-		return true;
-	}
+// Per-instance vertex attributes for instanced drawing
+struct InstanceData
+{
+	glm::mat4 model;
+	glm::vec3 color;
+};
 
-	bool IsAnimating() {
-		return animating;
-	}
+// Meshes sharing geometry and texture, drawn with one instanced call
+struct MeshBatch
+{
+	MeshBuffers *buffers;
+	unsigned int numVertices;
+	GLuint texture;
+	std::vector<InstanceData> instances;
+};
 
-	void Reset(int time) {
-		animating = true;
-		lastFrame = 0;
-		currentFrame = 1;
-		frameSwitchTime = time;
-	}
+// One level of detail of a mesh's geometry
+struct MeshLod
+{
+	MeshBuffers *buffers;
+	unsigned int numVertices;
 };
 
+// Levels of detail: a level is used while the mesh's bounding sphere is at least
+// lodPixelSize / 2^level pixels across on screen, or it is the last level
+const float lodPixelSize = 256.0f;
+bool lodEnabled = true;
+
 struct Mesh {
 	MeshBuffers *buffers;
 	unsigned int numVertices;
 
+	// finest first; lods[0] is buffers/numVertices
+	std::vector<MeshLod> lods;
+	// bounding sphere of the geometry around its origin, in model space
+	float boundingRadius;
+
 	std::string name;
 	glm::vec3 color;
 	glm::vec3 position;
 	glm::vec3 rotation;
 	glm::vec3 scale;
 	glm::mat4 transform;
+	// a reference from textures, released with the mesh
 	GLuint texture = GL_NONE;
 
 	Mesh(std::string n, MeshBuffers *b, unsigned int v) {
 		buffers = b;
 		numVertices = v;
+		lods.push_back({ b, v });
+		boundingRadius = 1.0f;
 
 		name = n;
 		color = glm::vec3(0.0f, 0.0f, 0.0f);
@@ -151,47 +172,13 @@ struct Mesh {
 	}
 };
 
-static GLuint createTexture(std::string filename) {
-	int imageWidth, imageHeight;
-	int numComponents;
-
-	unsigned char* bitmap = stbi_load(filename.c_str(),
-		&imageWidth,
-		&imageHeight,
-		&numComponents, 4);
-
-	GLuint textureId;
-	glGenTextures(1, &textureId);
-
-	glBindTexture(GL_TEXTURE_2D, textureId);
-
-	// resizing settings
-	glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_TRUE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+// Time; the Hanoi animation runs on the simulation clock, decoration on real time
+int previousTime = -1;
+SimulationClock simulationClock;
 
-	// provide the image data to OpenGL
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8,
-		imageWidth, imageHeight,
-		0, GL_RGBA, GL_UNSIGNED_BYTE, bitmap);
-
-	glGenerateMipmap(GL_TEXTURE_2D);
-
-	glBindTexture(GL_TEXTURE_2D, 0);
-	glActiveTexture(GL_TEXTURE0);
-
-	// free up the bitmap
-	stbi_image_free(bitmap);
-
-	return textureId;
-}
-
-// Time
-float previousTime = 0.0f;
-
-// Torus
-MeshBuffers torusBuffers;
-unsigned int torusNumVertices;
+// Disks; tori of unit outer diameter, shared by every disk of the same tube thickness
+// and scaled to size, so the disks draw as one instanced batch
+std::vector<MeshBuffers *> diskBuffers;
 
 // Cube
 MeshBuffers cubeBuffers;
@@ -201,9 +188,25 @@ unsigned int cubeNumVertices;
 MeshBuffers cylinderBuffers;
 unsigned int cylinderNumVertices;
 
-// Skybox
-MeshBuffers skyboxBuffers;
-unsigned int skyboxNumVertices;
+// Skybox, a cube map on a cube drawn around the eye
+GLuint skyboxVertexArray;
+GLuint skyboxVertices;
+// the orientation meshes/skybox.obj, the sphere the sky used to be drawn on, mapped
+// stars.jpeg with, as cube map directions (see skybox_vertex.glsl)
+const glm::vec3 skyboxFront(0.8189f, -0.4456f, 0.3618f);
+const glm::vec3 skyboxUp(0.4014f, 0.8952f, 0.1937f);
+// the skybox's faces are DXT compressed unless -no-texture-compression
+bool textureCompression = true;
+// how loaded textures' mip chains are filtered, -mip-filter box|kaiser
+int mipFilter = MIPMAP_FILTER_KAISER;
+// bytes of texture uploaded per frame while the skybox streams in, -texture-budget KB;
+// with 0 it is uploaded all at once
+size_t textureStreamBudget = TEXTURE_STREAM_BUDGET;
+
+// Reads the skybox texture in the background; a placeholder is drawn until then
+AssetManager *assets = nullptr;
+std::chrono::high_resolution_clock::time_point startTime;
+bool firstFrameReported = false;
 
 bool scaling = false;
 bool rotating = false;
@@ -226,13 +229,27 @@ glm::vec3 colorBlue(0.0, 0.0, 0.8);
 
 // Meshes
 std::vector<Mesh *> meshes;
-Mesh *skybox = new Mesh("Skybox", &skyboxBuffers, skyboxNumVertices);
+glm::mat4 skyboxTransform;
 float skyboxRotation = 0.0f;
 
-// Animations
-unsigned int currentAnimation = 0;
+// Towers of Hanoi; pegs are numbered source, spare, target
+unsigned int numDisks = 3;
+const float pegZ[3] = { 0.0f, -5.0f, 5.0f };
+const float diskBaseY = -1.8f;
+const float diskLiftY = 5.0f;
+const float maxStackHeight = 4.0f;
+float diskSpacing = 0.85f;
+std::vector<Mesh *> disks; // disks[0] is the smallest
+
+// Animations; only the move in progress has key frames, so memory does not grow
+// with the 2^N - 1 moves of the solution
 bool animating = true;
-std::vector<std::pair<Mesh *, Animation *>> animations;
+HanoiSolver *solver = nullptr;
+HanoiMove currentMove;
+Animation *moveAnimation = nullptr;
+// moving disk position after the previous and the latest simulation step
+glm::vec3 movingDiskPrevious;
+glm::vec3 movingDiskCurrent;
 
 bool animateLight = true;
 
@@ -241,64 +258,241 @@ float lastX = std::numeric_limits<float>::infinity();
 float lastY = std::numeric_limits<float>::infinity();
 
 // Forward declarations
-void drawMesh(MeshBuffers &buffers, unsigned int numVertices, glm::mat4 &modelMatrix, glm::vec3 &colour, GLuint texture);
+void drawMeshInstanced(MeshBatch &batch);
+static void drawSkybox(void);
 
-static void createGeometry(const char *fileName, MeshBuffers &buffers, unsigned int &numVertices) {
-	// Load mesh
-	ObjMesh mesh;
-	mesh.load(fileName, true, true);
+// Points the cached attribute locations at the currently bound interleaved vertex buffer
+static void setVertexAttributes(VertexLayout layout) {
+	if (layout == VERTEX_LAYOUT_PACKED) {
+		GLsizei stride = sizeof(PackedVertex);
 
-	numVertices = mesh.getNumIndexedVertices();
-	Vector3* vertexPositions = mesh.getIndexedPositions();
-	Vector2* vertexTextureCoords = mesh.getIndexedTextureCoords();
-	Vector3* vertexNormals = mesh.getIndexedNormals();
+		glEnableVertexAttribArray(locations.position);
+		glVertexAttribPointer(locations.position, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(PackedVertex, position));
 
-	glGenBuffers(1, &buffers.positions);
-	glBindBuffer(GL_ARRAY_BUFFER, buffers.positions);
-	glBufferData(GL_ARRAY_BUFFER, numVertices * sizeof(Vector3), vertexPositions, GL_STATIC_DRAW);
+		if (locations.textureCoords > -1) {
+			glEnableVertexAttribArray(locations.textureCoords);
+			glVertexAttribPointer(locations.textureCoords, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offsetof(PackedVertex, textureCoord));
+		}
 
-	glGenBuffers(1, &buffers.textureCoords);
-	glBindBuffer(GL_ARRAY_BUFFER, buffers.textureCoords);
-	glBufferData(GL_ARRAY_BUFFER, numVertices * sizeof(Vector2), vertexTextureCoords, GL_STATIC_DRAW);
+		if (locations.normal > -1) {
+			glEnableVertexAttribArray(locations.normal);
+			glVertexAttribPointer(locations.normal, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)offsetof(PackedVertex, normal));
+		}
+	}
+	else {
+		GLsizei stride = sizeof(Vertex);
+
+		glEnableVertexAttribArray(locations.position);
+		glVertexAttribPointer(locations.position, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Vertex, position));
+
+		if (locations.textureCoords > -1) {
+			glEnableVertexAttribArray(locations.textureCoords);
+			glVertexAttribPointer(locations.textureCoords, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Vertex, textureCoord));
+		}
+
+		if (locations.normal > -1) {
+			glEnableVertexAttribArray(locations.normal);
+			glVertexAttribPointer(locations.normal, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Vertex, normal));
+		}
+	}
+}
 
-	glGenBuffers(1, &buffers.normals);
-	glBindBuffer(GL_ARRAY_BUFFER, buffers.normals);
-	glBufferData(GL_ARRAY_BUFFER, numVertices * sizeof(Vector3), vertexNormals, GL_STATIC_DRAW);
+// Uploads welded vertices and triangle indices, and records the vertex array for them
+static void uploadGeometry(const std::vector<Vertex> &vertices, const unsigned int *indexData, unsigned int numTriangles, MeshBuffers &buffers, VertexLayout layout) {
+	buffers.layout = layout;
 
-	unsigned int* indexData = mesh.getTriangleIndices();
-	int numTriangles = mesh.getNumTriangles();
+	glGenBuffers(1, &buffers.vertices);
+	glBindBuffer(GL_ARRAY_BUFFER, buffers.vertices);
+
+	if (layout == VERTEX_LAYOUT_PACKED) {
+		std::vector<PackedVertex> packedVertices(vertices.size());
+		for (size_t i = 0; i < vertices.size(); i++) {
+			packedVertices[i] = packVertex(vertices[i]);
+		}
+		glBufferData(GL_ARRAY_BUFFER, packedVertices.size() * sizeof(PackedVertex), packedVertices.data(), GL_STATIC_DRAW);
+	}
+	else {
+		glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+	}
 
 	glGenBuffers(1, &buffers.index);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.index);
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * numTriangles * 3, indexData, GL_STATIC_DRAW);
+
+	// record the vertex layout once so drawing only has to bind the vertex array
+	glGenVertexArrays(1, &buffers.vertexArray);
+	glBindVertexArray(buffers.vertexArray);
+	glBindBuffer(GL_ARRAY_BUFFER, buffers.vertices);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.index);
+	setVertexAttributes(buffers.layout);
+
+	// instance attributes advance once per instance instead of once per vertex
+	glGenBuffers(1, &buffers.instances);
+	glBindBuffer(GL_ARRAY_BUFFER, buffers.instances);
+	buffers.instanceCapacity = 0;
+
+	if (locations.instanceModel > -1) {
+		for (int column = 0; column < 4; column++) {
+			GLuint location = locations.instanceModel + column;
+			glEnableVertexAttribArray(location);
+			glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(offsetof(InstanceData, model) + sizeof(glm::vec4) * column));
+			glVertexAttribDivisor(location, 1);
+		}
+	}
+
+	if (locations.instanceColor > -1) {
+		glEnableVertexAttribArray(locations.instanceColor);
+		glVertexAttribPointer(locations.instanceColor, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offsetof(InstanceData, color));
+		glVertexAttribDivisor(locations.instanceColor, 1);
+	}
+
+	glBindVertexArray(0);
+}
+
+// Geometry that is already in memory, e.g. generated procedurally; nothing is read from disk
+static void createGeometry(const glm::vec3 *positions, const glm::vec3 *normals, const glm::vec2 *textureCoords, unsigned int numIndexedVertices,
+	const unsigned int *indexData, unsigned int numTriangles, MeshBuffers &buffers, unsigned int &numVertices, VertexLayout layout) {
+	numVertices = numTriangles * 3;
+
+	std::vector<Vertex> vertices(numIndexedVertices);
+	for (unsigned int i = 0; i < numIndexedVertices; i++) {
+		vertices[i].position = { positions[i].x, positions[i].y, positions[i].z };
+		vertices[i].normal = { normals[i].x, normals[i].y, normals[i].z };
+		vertices[i].textureCoord = { textureCoords[i].s, textureCoords[i].t };
+	}
+
+	uploadGeometry(vertices, indexData, numTriangles, buffers, layout);
+}
+
+static void createGeometry(ProceduralMesh &mesh, MeshBuffers &buffers, unsigned int &numVertices, VertexLayout layout) {
+	createGeometry(mesh.getPositions(), mesh.getNormals(), mesh.getTextureCoords(), mesh.getNumVertices(),
+		mesh.getTriangleIndices(), mesh.getNumTriangles(), buffers, numVertices, layout);
+}
+
+// A cube around the origin as 36 positions, all the skybox shader takes; it is seen from inside
+// and culling is off, so the winding does not matter
+static void createSkyboxGeometry(void) {
+	static const float positions[] = {
+		-1.0f,  1.0f, -1.0f,  -1.0f, -1.0f, -1.0f,   1.0f, -1.0f, -1.0f,
+		 1.0f, -1.0f, -1.0f,   1.0f,  1.0f, -1.0f,  -1.0f,  1.0f, -1.0f,
+
+		-1.0f, -1.0f,  1.0f,  -1.0f, -1.0f, -1.0f,  -1.0f,  1.0f, -1.0f,
+		-1.0f,  1.0f, -1.0f,  -1.0f,  1.0f,  1.0f,  -1.0f, -1.0f,  1.0f,
+
+		 1.0f, -1.0f, -1.0f,   1.0f, -1.0f,  1.0f,   1.0f,  1.0f,  1.0f,
+		 1.0f,  1.0f,  1.0f,   1.0f,  1.0f, -1.0f,   1.0f, -1.0f, -1.0f,
+
+		-1.0f, -1.0f,  1.0f,  -1.0f,  1.0f,  1.0f,   1.0f,  1.0f,  1.0f,
+		 1.0f,  1.0f,  1.0f,   1.0f, -1.0f,  1.0f,  -1.0f, -1.0f,  1.0f,
+
+		-1.0f,  1.0f, -1.0f,   1.0f,  1.0f, -1.0f,   1.0f,  1.0f,  1.0f,
+		 1.0f,  1.0f,  1.0f,  -1.0f,  1.0f,  1.0f,  -1.0f,  1.0f, -1.0f,
+
+		-1.0f, -1.0f, -1.0f,  -1.0f, -1.0f,  1.0f,   1.0f, -1.0f, -1.0f,
+		 1.0f, -1.0f, -1.0f,  -1.0f, -1.0f,  1.0f,   1.0f, -1.0f,  1.0f,
+	};
+
+	glGenBuffers(1, &skyboxVertices);
+	glBindBuffer(GL_ARRAY_BUFFER, skyboxVertices);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(positions), positions, GL_STATIC_DRAW);
+
+	glGenVertexArrays(1, &skyboxVertexArray);
+	glBindVertexArray(skyboxVertexArray);
+	glEnableVertexAttribArray(skyboxLocations.position);
+	glVertexAttribPointer(skyboxLocations.position, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+	glBindVertexArray(0);
+}
+
+static void deleteGeometry(MeshBuffers &buffers) {
+	glDeleteVertexArrays(1, &buffers.vertexArray);
+	glDeleteBuffers(1, &buffers.vertices);
+	glDeleteBuffers(1, &buffers.index);
+	glDeleteBuffers(1, &buffers.instances);
+}
+
+// Resting position of a disk at a given level (0 is the bottom) of a peg
+static glm::vec3 diskPosition(unsigned int peg, unsigned int level) {
+	return glm::vec3(0.0f, diskBaseY + level * diskSpacing, pegZ[peg]);
+}
+
+// Pulls the next move from the solver and builds its lift/traverse/drop key frames.
+// Returns false once the puzzle is solved.
+static bool startNextMove(unsigned long long timeMs) {
+	if (!solver->nextMove(currentMove)) {
+		return false;
+	}
+
+	// the solver has already applied the move, so the disk left the level that is now
+	// the top of its old peg, and sits at the top of its new one
+	glm::vec3 start = diskPosition(currentMove.from, solver->getPegHeight(currentMove.from));
+	glm::vec3 end = diskPosition(currentMove.to, solver->getPegHeight(currentMove.to) - 1);
+	unsigned int traverseTime = 1000 + (unsigned int)(100.0f * glm::abs(end.z - start.z));
+
+	delete moveAnimation;
+	moveAnimation = new Animation({
+		Frame(start, 0), // Initial position
+		Frame(glm::vec3(start.x, diskLiftY, start.z), 3000), // Lifted off the peg
+		Frame(glm::vec3(end.x, diskLiftY, end.z), traverseTime), // Above the target peg
+		Frame(end, 3000), // Dropped onto the stack
+		});
+	moveAnimation->Reset(timeMs);
+
+	movingDiskPrevious = start;
+	movingDiskCurrent = start;
+
+	return true;
+}
+
+static void setDiskTransform(Mesh *disk, glm::vec3 position) {
+	disk->position = position;
+	disk->transform = glm::translate(glm::mat4(1.0f), position);
+	disk->transform = glm::scale(disk->transform, disk->scale);
+}
+
+// Jumps straight to the state after the first moveIndex moves; the move after it is
+// animated from the next update()
+static void seekToMove(unsigned long long moveIndex) {
+	solver->seek(moveIndex);
+
+	for (unsigned int peg = 0; peg < 3; peg++) {
+		const std::vector<unsigned int> &pegDisks = solver->getPegDisks(peg);
+		for (unsigned int level = 0; level < pegDisks.size(); level++) {
+			setDiskTransform(disks[pegDisks[level]], diskPosition(peg, level));
+		}
+	}
+
+	delete moveAnimation;
+	moveAnimation = nullptr;
+	animating = solver->getMovesMade() < solver->getNumMoves();
+
+	std::cout << "Move " << solver->getMovesMade() << " of " << solver->getNumMoves() << std::endl;
 }
 
 static void initMeshes() {
-	// Create geometry types
-	createGeometry("meshes/torus.obj", torusBuffers, torusNumVertices);
-	createGeometry("meshes/cube.obj", cubeBuffers, cubeNumVertices);
+	// Create geometry types, generated Parametrically at the unit size the .obj loader used to normalize to
+	Box cube(1.0f, 1.0f, 1.0f);
+	createGeometry(cube, cubeBuffers, cubeNumVertices, VERTEX_LAYOUT_PACKED);
 
-	// Cylinder generated Parametrically
-	UVCylinder cylinder(1.0, 12);
-	cylinder.save("meshes/my_cylinder.obj");
-	createGeometry("meshes/my_cylinder.obj", cylinderBuffers, cylinderNumVertices);
+	UVCylinder cylinder(0.5f, 12, 1.0f);
+	createGeometry(cylinder, cylinderBuffers, cylinderNumVertices, VERTEX_LAYOUT_PACKED);
+
+	// The skybox, with a plain cube map until loadAssets has the real one
+	createSkyboxGeometry();
+
+	const unsigned char placeholderPixel[4] = { 8, 8, 24, 255 };
+	CubemapImage placeholder;
+	placeholder.faceSize = 1;
+	placeholder.faces.resize(CUBEMAP_FACES, MipLevel{ 1, 1, std::vector<unsigned char>(placeholderPixel, placeholderPixel + 4) });
+	placeholder.mips.resize(CUBEMAP_FACES);
+	skyboxTexture = textures.acquire("skybox placeholder", 0, placeholder);
+
+	skyboxTransform = glm::rotate(glm::mat4(1.0f), glm::radians(120.0f), glm::vec3(0.0f, 1.0f, 0.0f));
 
 	// Init meshes
-	skybox = new Mesh("Skybox", &skyboxBuffers, skyboxNumVertices);
 	Mesh *rectBase = new Mesh("Base", &cubeBuffers, cubeNumVertices);
 	Mesh *poleOne = new Mesh("PoleOne", &cylinderBuffers, cylinderNumVertices);
 	Mesh *poleTwo = new Mesh("PoleTwo", &cylinderBuffers, cylinderNumVertices);
 	Mesh *poleThree = new Mesh("PoleThree", &cylinderBuffers, cylinderNumVertices);
-	Mesh *diskOne = new Mesh("DiskOne", &torusBuffers, torusNumVertices);
-	Mesh *diskTwo = new Mesh("DiskTwo", &torusBuffers, torusNumVertices);
-	Mesh *diskThree = new Mesh("DiskThree", &torusBuffers, torusNumVertices);
-
-	skybox->color = colorBlue;
-	skybox->position = glm::vec3(0.0f, 0.0f, 0.0f);
-	skybox->scale = glm::vec3(40.0f, 40.0f, 40.0f);
-	skybox->rotation = glm::vec3(0.0f, 120.0f, 0.0f);
-	skybox->texture = createTexture("textures/stars.jpeg");
-	meshes.push_back(skybox);
 
 	// Base
 	rectBase->color = colorRed;
@@ -309,186 +503,211 @@ static void initMeshes() {
 	// Pole one
 	poleOne->color = colorBlue;
 	poleOne->position = glm::vec3(0.0f, 0.0f, -5.0f);
-	poleOne->rotation = glm::vec3(90.0f, 0.0f, 0.0f);
-	poleOne->scale = glm::vec3(1.0f, 1.0f, 5.0f);
+	poleOne->scale = glm::vec3(1.0f, 5.0f, 1.0f);
 	meshes.push_back(poleOne);
 
 	// Pole two
 	poleTwo->color = colorBlue;
 	poleTwo->position = glm::vec3(0.0f, 0.0f, 0.0f);
-	poleTwo->rotation = glm::vec3(90.0f, 0.0f, 0.0f);
-	poleTwo->scale = glm::vec3(1.0f, 1.0f, 5.0f);
+	poleTwo->scale = glm::vec3(1.0f, 5.0f, 1.0f);
 	meshes.push_back(poleTwo);
 
 	// Pole three
 	poleThree->color = colorBlue;
 	poleThree->position = glm::vec3(0.0f, 0.0f, 5.0f);
-	poleThree->rotation = glm::vec3(90.0f, 0.0f, 0.0f);
-	poleThree->scale = glm::vec3(1.0f, 1.0f, 5.0f);
+	poleThree->scale = glm::vec3(1.0f, 5.0f, 1.0f);
 	meshes.push_back(poleThree);
 
-	// Disk one
-	diskOne->color = colorGreen;
-	diskOne->scale = glm::vec3(4.0f);
-	meshes.push_back(diskOne);
-
-	// Disk two
-	diskTwo->color = colorYellow;
-	diskTwo->scale = glm::vec3(3.0f);
-	meshes.push_back(diskTwo);
-
-	// Disk three
-	diskThree->color = colorPink;
-	diskThree->scale = glm::vec3(2.2f);
-	meshes.push_back(diskThree);
-
-	// Init animations
-	// Disk three: Part 1
-	animations.push_back({
-		diskThree,
-		new Animation({
-			Frame(glm::vec3(0.0f, -0.05f, 0.0f), 0), // Initial position
-			Frame(glm::vec3(0.0f, 5.00f, 0.0f), 3000), // First position
-			Frame(glm::vec3(0.0f, 5.00f, 5.00f), 1500), // Second position
-			Frame(glm::vec3(0.0f, -1.80f, 5.00f), 3000), // Third position
-			})
-		});
-
-	animations.push_back({
-		diskTwo,
-		new Animation({
-			Frame(glm::vec3(0.0f, -0.8f, 0.0f), 0),
-			Frame(glm::vec3(0.0f, 5.00f, 0.0f), 3000),
-			Frame(glm::vec3(0.0f, 5.00f, -5.00f), 1500),
-			Frame(glm::vec3(0.0f, -1.80f, -5.00f), 3000),
-			})
-		});
-
-	animations.push_back({
-		diskThree,
-		new Animation({
-			Frame(glm::vec3(0.0f, -1.80f, 5.0f), 0),
-			Frame(glm::vec3(0.0f, 5.0f, 5.0f), 3000),
-			Frame(glm::vec3(0.0f, 5.0f, -5.0f), 2000),
-			Frame(glm::vec3(0.0f, -0.85f, -5.00f), 3000),
-			})
-		});
-
-	animations.push_back({
-		diskOne,
-		new Animation({
-			Frame(glm::vec3(0.0f, -1.8f, 0.0f), 0),
-			Frame(glm::vec3(0.0f, 5.0f, 0.0f), 3000),
-			Frame(glm::vec3(0.0f, 5.0f, 5.0f), 1500),
-			Frame(glm::vec3(0.0f, -1.8f, 5.0f), 3000),
-			})
-		});
-
-	animations.push_back({
-		diskThree,
-		new Animation({
-			Frame(glm::vec3(0.0f, -0.85f, -5.00f), 0),
-			Frame(glm::vec3(0.0f, 5.00f, -5.00f), 3000),
-			Frame(glm::vec3(0.0f, 5.0f, 0.0f), 2000),
-			Frame(glm::vec3(0.0f, -1.8f, 0.0f), 3000),
-			})
-		});
-
-	animations.push_back({
-		diskTwo,
-		new Animation({
-			Frame(glm::vec3(0.0f, -0.8f, -5.0f),0),
-			Frame(glm::vec3(0.0f, 5.0f, -5.0f),2000),
-			Frame(glm::vec3(0.0f, 5.0f, 5.00f), 3000),
-			Frame(glm::vec3(0.0f, -0.8f, 5.00f), 3000)
-			})
-		});
-
-	animations.push_back({
-		diskThree,
-		new Animation({
-			Frame(glm::vec3(0.0f, -1.8f, 0.0f), 0),
-			Frame(glm::vec3(0.0f, 5.0f, 0.0f), 3000),
-			Frame(glm::vec3(0.0f, 5.0f, 5.0f), 2000),
-			Frame(glm::vec3(0.0f, -0.05f, 5.0f), 3000),
-			})
-		});
-
-	animations.push_back({
-		diskThree,
-		new Animation({
-			Frame(glm::vec3(0.0f, -1.8f, 0.0f), 0),
-			})
-		});
-
-	// Set initial transforms for animations
-	std::map<Mesh *, bool> meshesUpdated;
-	for (auto p : animations) {
-		Mesh *m = p.first;
+	// Disks, stacked largest first on the source peg and squashed to fit when there are many
+	diskSpacing = glm::min(0.85f, maxStackHeight / numDisks);
+	glm::vec3 diskColors[] = { colorPink, colorYellow, colorGreen };
+
+	// tori by tube thickness, each thinner than the last by sqrt(2)
+	std::map<int, std::vector<MeshLod>> diskLods;
+
+	for (unsigned int i = 0; i < numDisks; i++) {
+		// outer diameter, and a round tube as thick as the old scaled torus.obj (0.15 of
+		// the diameter) but thin enough to stack in the spacing
+		float size = numDisks > 1 ? lerp(2.2f, 4.0f, (float)i / (numDisks - 1)) : 4.0f;
+		float tubeFraction = glm::min(0.15f, 0.6f * diskSpacing / 0.85f / size);
+
+		// the first torus at least that thin; only many disks need any but the first
+		int thickness = (int)ceilf(2.0f * log2f(0.15f / tubeFraction) - 0.001f);
+		std::vector<MeshLod> &lods = diskLods[thickness];
+		if (lods.empty()) {
+			float tubeRadius = 0.15f * powf(2.0f, -0.5f * thickness);
+
+			// each level halves the segments of the one before
+			for (unsigned int level = 0; level < 4; level++) {
+				UVTorus torus(0.5f - tubeRadius, tubeRadius, 64 >> level, glm::max(24u >> level, 4u));
+
+				MeshLod lod;
+				lod.buffers = new MeshBuffers();
+				createGeometry(torus, *lod.buffers, lod.numVertices, VERTEX_LAYOUT_PACKED);
+				diskBuffers.push_back(lod.buffers);
+				lods.push_back(lod);
+			}
+		}
 
-		// We only want to set the transform ONCE for each animated mesh, using the first animation
-		if (meshesUpdated[m])
-			continue;
+		Mesh *disk = new Mesh("Disk" + std::to_string(i), lods[0].buffers, lods[0].numVertices);
+		disk->lods = lods;
+		disk->boundingRadius = 0.5f;
+		disk->color = diskColors[i % 3];
+		disk->position = diskPosition(0, numDisks - 1 - i);
+		disk->scale = glm::vec3(size);
+		disks.push_back(disk);
+		meshes.push_back(disk);
+	}
 
-		Animation *animation = p.second;
+	solver = new HanoiSolver(numDisks);
+	std::cout << "Solving " << numDisks << " disks in " << solver->getNumMoves() << " moves" << std::endl;
 
+	// Set static transforms; disks are updated by update() while they move
+	for (auto m : meshes) {
 		// Reset transform
 		m->transform = glm::mat4(1.0f);
 
-		// Apply translations from first key frame
-		animation->Update(0.0f, m->transform);
+		// Apply translation
+		m->transform = glm::translate(m->transform, m->position);
+
+		// Apply rotation
+		m->transform = glm::rotate(m->transform, glm::radians(m->rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
+		m->transform = glm::rotate(m->transform, glm::radians(m->rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
+		m->transform = glm::rotate(m->transform, glm::radians(m->rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
 
 		// Apply scale
 		m->transform = glm::scale(m->transform, m->scale);
-
-		meshesUpdated[m] = true;
 	}
+}
 
-	// Set static transforms for meshes that don't animate
-	for (auto m : meshes) {
-		if (meshesUpdated.find(m) == meshesUpdated.end()) {
-			// Reset transform
-			m->transform = glm::mat4(1.0f);
+static double millisecondsSinceStart(void) {
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+}
 
-			// Apply translation
-			m->transform = glm::translate(m->transform, m->position);
+// Starts reading the skybox; the GL half runs in updateScene once the load finishes
+static void loadAssets() {
+	bool compress = textureCompression && TextureCache::isCompressionSupported();
+	assets->loadCubemap("textures/stars.jpeg", skyboxFront, skyboxUp, mipFilter, compress, [](CubemapImage &image) {
+		if (image.faces.empty() && image.compressedFaces.empty()) {
+			std::cerr << "Could not load texture " << image.filename << ": " << image.error << ", keeping the placeholder" << std::endl;
+			return;
+		}
 
-			// Apply rotation
-			m->transform = glm::rotate(m->transform, glm::radians(m->rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-			m->transform = glm::rotate(m->transform, glm::radians(m->rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-			m->transform = glm::rotate(m->transform, glm::radians(m->rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+		std::cout << "Skybox cube map, " << image.faceSize << "x" << image.faceSize << " faces";
+		if (!image.compressedFaces.empty()) {
+			size_t uncompressedSize = 0;
+			for (const CompressedImage &face : image.compressedFaces) {
+				uncompressedSize += face.getUncompressedSize();
+			}
+			std::cout << " " << (image.compressedFaces[0].format == TEXTURE_FORMAT_DXT1 ? "DXT1" : "DXT5") << (image.compressedFaces[0].fromCache ? " from cache" : "")
+				<< ": " << image.getSize() / 1024 << " KB, "
+				<< (uncompressedSize - image.getSize()) / 1024 << " KB less than RGBA8" << std::endl;
+		}
+		else {
+			std::cout << ": " << image.getSize() / 1024 << " KB" << std::endl;
+		}
+
+		// the skybox's reference moves from the placeholder to the loaded texture
+		textures.release(skyboxTexture);
+		skyboxTexture = textureStreamBudget > 0 ? textures.stream(image.filename, image.hash, image) : textures.acquire(image.filename, image.hash, image);
+	});
+}
 
-			// Apply scale
-			m->transform = glm::scale(m->transform, m->scale);
+// Uploads whatever finished loading since the last frame, and the next part of the
+// textures still streaming in
+static void processAssets(void) {
+	if (assets->processCompletions() > 0 && assets->getNumPending() == 0) {
+		std::cout << "All assets loaded after " << millisecondsSinceStart() << " ms" << std::endl;
+	}
+
+	if (textures.getNumStreaming() > 0) {
+		textures.update();
+		if (textures.getNumStreaming() == 0) {
+			std::cout << "Textures streamed in after " << millisecondsSinceStart() << " ms" << std::endl;
 		}
 	}
 }
 
+// Time to first frame, from the start of main until the GPU has finished drawing it
+static void reportFirstFrame(void) {
+	if (firstFrameReported) {
+		return;
+	}
+
+	glFinish();
+	std::cout << "First frame after " << millisecondsSinceStart() << " ms, with " << assets->getNumPending() << " assets still loading" << std::endl;
+	firstFrameReported = true;
+}
+
 void cleanupMeshes() {
 	// Delete anims
-	for (auto p : animations) {
-		delete p.second;
-	}
+	delete moveAnimation;
+	moveAnimation = nullptr;
 
-	animations.clear();
+	delete solver;
+	solver = nullptr;
 
-	// Delete meshes
+	// Delete meshes, and the texture references they hold
 	for (Mesh *m : meshes) {
+		textures.release(m->texture);
 		delete m;
 	}
 
+	textures.release(skyboxTexture);
+	skyboxTexture = GL_NONE;
+	glDeleteVertexArrays(1, &skyboxVertexArray);
+	glDeleteBuffers(1, &skyboxVertices);
+
 	meshes.clear();
+	disks.clear();
+
+	for (MeshBuffers *buffers : diskBuffers) {
+		deleteGeometry(*buffers);
+		delete buffers;
+	}
+	diskBuffers.clear();
 }
 
-static void update(void) {
-	int timeMs = glutGet(GLUT_ELAPSED_TIME); // milliseconds
-	int deltaTimeMs = timeMs - previousTime;
+// One fixed step of the Hanoi animation; simulation time only, so it runs the same at any frame rate
+static void simulate(unsigned long long timeMs) {
+	// Check if we're animating
+	if (animating && moveAnimation == nullptr) {
+		animating = startNextMove(timeMs);
+	}
+
+	if (!animating) {
+		return;
+	}
+
+	// Key frame position at this step
+	glm::mat4 transform(1.0f);
+	movingDiskPrevious = movingDiskCurrent;
+	if (moveAnimation->Update(timeMs, transform)) {
+		movingDiskCurrent = glm::vec3(transform[3]);
+	}
+
+	// Check if the move is done, then settle the disk and move onto the next
+	if (!moveAnimation->IsAnimating()) {
+		setDiskTransform(disks[currentMove.disk], diskPosition(currentMove.to, solver->getPegHeight(currentMove.to) - 1));
+
+		// If we've made the last move stop animating; the next one starts when this one
+		// ended rather than at this step, so moves do not drift by part of a step each
+		animating = startNextMove(moveAnimation->GetEndTime());
+	}
+}
+
+static void updateScene(int timeMs) {
+	profiler.begin(PROFILE_UPDATE);
+
+	processAssets();
+
+	int deltaTimeMs = previousTime < 0 ? 0 : timeMs - previousTime;
 
 	// Update skybox
 	skyboxRotation += deltaTimeMs / 19999.0f;
 
-	skybox->rotation.y = glm::radians(skyboxRotation);
-	skybox->transform = glm::rotate(skybox->transform, glm::radians(skybox->rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
+	float skyboxAngle = glm::radians(skyboxRotation);
+	skyboxTransform = glm::rotate(skyboxTransform, glm::radians(skyboxAngle), glm::vec3(0.0f, 1.0f, 0.0f));
 
 	lightRotation += 0.005f;
 
@@ -515,128 +734,198 @@ static void update(void) {
 	publicViewMatrix = view;
 	publicProjectionMatrix = projection;
 
-	// Check if we're animating
-	if (animating && !animations.empty())
-	{
-		// Get current animation
-		auto p = animations[currentAnimation];
-		auto mesh = p.first;
-		auto animation = p.second;
-
-		// Create transform matrix and apply translations to it
-		glm::mat4 transform(1.0f);
-		if (animation->Update(timeMs, transform))
-		{
-			// Update current transform matrix with new one
-			mesh->transform = transform;
-
-			// Apply scale
-			mesh->transform = glm::scale(mesh->transform, mesh->scale);
-		}
-
-		// Check if animation is done, then move onto next
-		if (!animation->IsAnimating())
-		{
-			// If we've reached the end of animations stop animating
-			if (++currentAnimation >= animations.size() - 1)
-			{
-				animating = false;
-			}
-			else
-			{
-				// Reset next animation with current time
-				p = animations[currentAnimation];
-				animation = p.second;
-				animation->Reset(timeMs);
-			}
-		}
+	profiler.begin(PROFILE_ANIMATION);
+
+	simulationClock.advance(deltaTimeMs);
+	while (simulationClock.step()) {
+		simulate(simulationClock.getTimeMs());
 	}
 
-	glutPostRedisplay();
+	// Draw the moving disk part way between the last two steps
+	if (animating && moveAnimation != nullptr) {
+		Mesh *mesh = disks[currentMove.disk];
+		glm::vec3 position = lerp(movingDiskPrevious, movingDiskCurrent, simulationClock.getAlpha());
+
+		mesh->transform = glm::translate(glm::mat4(1.0f), position);
+		mesh->transform = glm::scale(mesh->transform, mesh->scale);
+	}
+
+	profiler.end(PROFILE_ANIMATION);
 
 	previousTime = timeMs;
+
+	profiler.end(PROFILE_UPDATE);
 }
 
-static void render(void) {
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+static void update(void) {
+	int timeMs = glutGet(GLUT_ELAPSED_TIME); // milliseconds
+	updateScene(timeMs);
 
-	// activate our shader program
-	glUseProgram(programId);
+	// Frame time statistics, once a second while switched on
+	if (showProfile && timeMs - lastProfileShownMs >= 1000) {
+		double min, avg, p99;
+		profiler.getStats(PROFILE_GPU, min, avg, p99);
+		double gpuAvg = avg;
+		profiler.getStats(PROFILE_DRAW, min, avg, p99);
 
-	// turn on depth buffering
-	glEnable(GL_DEPTH_TEST);
+		char title[128];
+		snprintf(title, sizeof(title), "Final Project - draw %.2f ms avg, %.2f ms p99, gpu %.2f ms avg", avg, p99, gpuAvg);
+		glutSetWindowTitle(title);
+		profiler.print(std::cout);
 
-	// Draw all meshes
-	for (Mesh *m : meshes) {
-		drawMesh(*m->buffers, m->numVertices, m->transform, m->color, m->texture);
+		lastProfileShownMs = timeMs;
 	}
 
-	// Swap front buffer with back buffer to display changes
-	glutSwapBuffers();
+	glutPostRedisplay();
 }
 
-void drawMesh(MeshBuffers &buffers, unsigned int numVertices, glm::mat4 &modelMatrix, glm::vec3 &colour, GLuint texture) {
-	// model-view-projection matrix
-	glm::mat4 mvp = publicProjectionMatrix * publicViewMatrix * modelMatrix;
-	GLuint mvpMatrixId = glGetUniformLocation(programId, "u_MVP");
-	glUniformMatrix4fv(mvpMatrixId, 1, GL_FALSE, &mvp[0][0]);
+// Picks the coarsest level that still suits the mesh's projected size on screen
+static const MeshLod& selectLod(const Mesh *m) {
+	if (!lodEnabled || m->lods.size() == 1) {
+		return m->lods[0];
+	}
+
+	glm::vec3 centre = glm::vec3(publicViewMatrix * m->transform[3]);
+	float scale = glm::max(glm::length(glm::vec3(m->transform[0])), glm::max(glm::length(glm::vec3(m->transform[1])), glm::length(glm::vec3(m->transform[2]))));
+	float radius = m->boundingRadius * scale;
 
-	GLuint lightPosId = glGetUniformLocation(programId, "u_lightPosDir");
-	glUniform4fv(lightPosId, 1, &lightPosDir[0]);
+	// the camera looks down -z; anything this close (or behind) is drawn in full
+	float distance = -centre.z;
+	if (distance <= radius) {
+		return m->lods[0];
+	}
 
-	GLuint colourId = glGetUniformLocation(programId, "u_color");
-	glUniform3fv(colourId, 1, (GLfloat*)&colour[0]);
-	// TODO: ...
+	float diameterPixels = radius * publicProjectionMatrix[1][1] * height / distance;
 
-	if (texture == GL_NONE) {
-		GLuint textured = glGetUniformLocation(programId, "u_textured");
-		glUniform1i(textured, 0);
+	unsigned int level = 0;
+	float threshold = lodPixelSize;
+	while (level + 1 < m->lods.size() && diameterPixels < threshold) {
+		level++;
+		threshold *= 0.5f;
 	}
-	else {
+	return m->lods[level];
+}
+
+// Draws the scene into the current framebuffer
+static void renderScene(void) {
+	glCallsThisFrame = 0;
+	verticesThisFrame = 0;
+	profiler.beginGpu();
 
-		GLuint textured = glGetUniformLocation(programId, "u_textured");
-		glUniform1i(textured, 1);
+	COUNT_GL(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
 
-		GLuint textureId = glGetUniformLocation(programId, "u_texture");
-		glUniform1i(textureId, 0); // Channel 0
+	// activate our shader program
+	COUNT_GL(glUseProgram(programId));
 
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, texture);
+	// turn on depth buffering
+	COUNT_GL(glEnable(GL_DEPTH_TEST));
+
+	// uniforms shared by every mesh this frame
+	glm::mat4 viewProjection = publicProjectionMatrix * publicViewMatrix;
+	COUNT_GL(glUniformMatrix4fv(locations.viewProjection, 1, GL_FALSE, &viewProjection[0][0]));
+	COUNT_GL(glUniform4fv(locations.lightPosDir, 1, &lightPosDir[0]));
+	COUNT_GL(glUniform1i(locations.texture, 0)); // Channel 0
+	COUNT_GL(glActiveTexture(GL_TEXTURE0));
+
+	// Group meshes by geometry and texture; the batches are kept between frames so
+	// the instance arrays keep their capacity
+	profiler.begin(PROFILE_TRANSFORMS);
+	static std::map<std::pair<MeshBuffers *, GLuint>, MeshBatch> batches;
+	for (auto &entry : batches) {
+		entry.second.instances.clear();
 	}
-	// find the names (ids) of each vertex attribute
-	GLint positionAttribId = glGetAttribLocation(programId, "position");
-	GLint textureCoordsAttribId = glGetAttribLocation(programId, "textureCoords");
-	GLint normalAttribId = glGetAttribLocation(programId, "normal");
 
-	// provide the vertex positions to the shaders
-	glBindBuffer(GL_ARRAY_BUFFER, buffers.positions);
-	glEnableVertexAttribArray(positionAttribId);
-	glVertexAttribPointer(positionAttribId, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+	for (Mesh *m : meshes) {
+		const MeshLod &lod = selectLod(m);
 
-	// provide the vertex texture coordinates to the shaders
-	if (textureCoordsAttribId > -1) {
-		// NOTE: This is a ghetto fix until we figure out what's up with the shader, my money is on optimization
-		glBindBuffer(GL_ARRAY_BUFFER, buffers.textureCoords);
-		glEnableVertexAttribArray(textureCoordsAttribId);
-		glVertexAttribPointer(textureCoordsAttribId, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+		MeshBatch &batch = batches[std::make_pair(lod.buffers, m->texture)];
+		batch.buffers = lod.buffers;
+		batch.texture = m->texture;
+		batch.numVertices = lod.numVertices;
+
+		InstanceData instance;
+		instance.model = m->transform;
+		instance.color = m->color;
+		batch.instances.push_back(instance);
 	}
 
-	// provide the vertex normals to the shaders
-	if (normalAttribId > -1) {
-		// NOTE: This is a ghetto fix until we figure out what's up with the shader, my money is on optimization
-		glBindBuffer(GL_ARRAY_BUFFER, buffers.normals);
-		glEnableVertexAttribArray(normalAttribId);
-		glVertexAttribPointer(normalAttribId, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+	profiler.end(PROFILE_TRANSFORMS);
+
+	// Draw all meshes, then the sky behind them
+	profiler.begin(PROFILE_DRAW);
+	for (auto &entry : batches) {
+		if (!entry.second.instances.empty()) {
+			drawMeshInstanced(entry.second);
+		}
+	}
+	drawSkybox();
+
+	COUNT_GL(glBindVertexArray(0));
+	profiler.end(PROFILE_DRAW);
+
+	profiler.endGpu();
+	profiler.endFrame();
+
+	glCallsLastFrame = glCallsThisFrame;
+	verticesLastFrame = verticesThisFrame;
+}
+
+static void render(void) {
+	renderScene();
+
+	// Swap front buffer with back buffer to display changes
+	glutSwapBuffers();
+
+	reportFirstFrame();
+}
+
+void drawMeshInstanced(MeshBatch &batch) {
+	MeshBuffers &buffers = *batch.buffers;
+	unsigned int numInstances = batch.instances.size();
+
+	// stream this frame's instances; the storage is only re-specified when it has to
+	// grow, and otherwise just overwritten
+	COUNT_GL(glBindBuffer(GL_ARRAY_BUFFER, buffers.instances));
+	if (numInstances > buffers.instanceCapacity) {
+		buffers.instanceCapacity = numInstances * 2;
+		COUNT_GL(glBufferData(GL_ARRAY_BUFFER, buffers.instanceCapacity * sizeof(InstanceData), nullptr, GL_STREAM_DRAW));
+	}
+	COUNT_GL(glBufferSubData(GL_ARRAY_BUFFER, 0, numInstances * sizeof(InstanceData), batch.instances.data()));
+
+	if (batch.texture == GL_NONE) {
+		COUNT_GL(glUniform1i(locations.textured, 0));
+	}
+	else {
+		COUNT_GL(glUniform1i(locations.textured, 1));
+		COUNT_GL(glBindTexture(GL_TEXTURE_2D, batch.texture));
 	}
 
 	// draw the triangles
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.index);
-	glDrawElements(GL_TRIANGLES, numVertices, GL_UNSIGNED_INT, (void*)0);
+	COUNT_GL(glBindVertexArray(buffers.vertexArray));
+	COUNT_GL(glDrawElementsInstanced(GL_TRIANGLES, batch.numVertices, GL_UNSIGNED_INT, (void*)0, numInstances));
+	verticesThisFrame += (unsigned long long)batch.numVertices * numInstances;
+}
 
-	// disable the attribute arrays
-	glDisableVertexAttribArray(positionAttribId);
-	if (textureCoordsAttribId > -1) glDisableVertexAttribArray(textureCoordsAttribId);
-	if (normalAttribId > -1) glDisableVertexAttribArray(normalAttribId);
+// Last, so early depth testing skips every pixel the scene already covered; the
+// shader puts the cube on the far plane, which only passes where nothing was drawn
+static void drawSkybox(void) {
+	// the shader drops the translation, so the sky stays around the eye
+	glm::mat4 modelView = publicViewMatrix * skyboxTransform;
+
+	COUNT_GL(glUseProgram(skyboxProgramId));
+	COUNT_GL(glUniformMatrix4fv(skyboxLocations.modelView, 1, GL_FALSE, &modelView[0][0]));
+	COUNT_GL(glUniformMatrix4fv(skyboxLocations.projection, 1, GL_FALSE, &publicProjectionMatrix[0][0]));
+	COUNT_GL(glUniform1i(skyboxLocations.textureSampler, 0));
+	COUNT_GL(glBindTexture(GL_TEXTURE_CUBE_MAP, skyboxTexture));
+
+	// the cleared depth is the far plane too, so equal has to pass; the sky writes no depth
+	COUNT_GL(glDepthFunc(GL_LEQUAL));
+	COUNT_GL(glDepthMask(GL_FALSE));
+	COUNT_GL(glBindVertexArray(skyboxVertexArray));
+	COUNT_GL(glDrawArrays(GL_TRIANGLES, 0, 36));
+	COUNT_GL(glDepthMask(GL_TRUE));
+	COUNT_GL(glDepthFunc(GL_LESS));
+	verticesThisFrame += 36;
 }
 
 static void reshape(int w, int h) {
@@ -652,21 +941,172 @@ static void keyboard(unsigned char key, int x, int y) {
 	if (key == 'l') {
 		animateLight = !animateLight;
 	}
+	else if (key == 'g') {
+		std::cout << "GL calls last frame: " << glCallsLastFrame << ", vertices: " << verticesLastFrame
+			<< ", textures: " << textures.getNumTextures() << " (" << textures.getGpuBytes() / 1024 << " KB, " << textures.getNumStreaming() << " streaming)" << std::endl;
+	}
+	else if (key == ',' || key == '.' || key == '[' || key == ']') {
+		// the solver has already counted the move being animated; once solved the last
+		// move's animation is kept but finished, so there is nothing to take back
+		unsigned long long moveIndex = solver->getMovesMade();
+		if (animating && moveAnimation != nullptr && moveIndex > 0) {
+			moveIndex--;
+		}
+
+		// ,/. step one move, [/] skip a sixteenth of the solution
+		unsigned long long step = 1;
+		if ((key == '[' || key == ']') && solver->getNumMoves() >= 16) {
+			step = solver->getNumMoves() / 16;
+		}
+		if (key == ',' || key == '[') {
+			moveIndex = moveIndex > step ? moveIndex - step : 0;
+		}
+		else {
+			moveIndex += step;
+		}
+
+		seekToMove(moveIndex);
+	}
+	else if (key == '+' || key == '=' || key == '-') {
+		// up to 1000x, so long solutions can be fast-forwarded; every step still runs
+		double timeScale = simulationClock.getTimeScale() * (key == '-' ? 0.1 : 10.0);
+		if (timeScale >= 1.0) {
+			timeScale = floor(timeScale + 0.5);
+		}
+		simulationClock.setTimeScale(glm::clamp(timeScale, 0.1, 1000.0));
+		std::cout << "Time scale: " << simulationClock.getTimeScale() << "x" << std::endl;
+	}
+	else if (key == 'p') {
+		simulationClock.setPaused(!simulationClock.isPaused());
+	}
+	else if (key == 'o') {
+		lodEnabled = !lodEnabled;
+		std::cout << "Level of detail " << (lodEnabled ? "on" : "off") << std::endl;
+	}
+	else if (key == 'f') {
+		showProfile = !showProfile;
+		if (!showProfile) {
+			glutSetWindowTitle("Final Project");
+		}
+	}
+}
+
+// Renders a fixed number of frames offscreen at a steady 60 frames per second of scene
+// time, so runs are repeatable, optionally saving each one as framePrefixNNNN.ppm.
+// main has the assets loaded before the first one unless -async-assets.
+static void runHeadless(HeadlessContext &context, unsigned int numFrames, const std::string framePrefix) {
+	// GLUT is not initialized without a window, so it cannot tell the time here
+	auto start = std::chrono::high_resolution_clock::now();
+
+	for (unsigned int frame = 0; frame < numFrames; frame++) {
+		updateScene(frame * 1000 / 60);
+		renderScene();
+		reportFirstFrame();
+
+		if (!framePrefix.empty()) {
+			char frameNumber[16];
+			snprintf(frameNumber, sizeof(frameNumber), "%04u", frame);
+			context.saveFrame(framePrefix + frameNumber + ".ppm");
+		}
+	}
+	glFinish();
+
+	double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	std::cout << "Rendered " << numFrames << " frames in " << elapsedMs << " ms ("
+		<< numFrames * 1000.0 / elapsedMs << " fps)" << std::endl;
+}
+
+#ifdef FREEGLUT
+// While the window's context is still current, so the frames waiting on the GPU can
+// be resolved before GLUT exits
+static void closeWindow(void) {
+	profiler.close();
+}
+#endif
+
+// At exit, which is also how GLUT leaves its main loop. The context may already be
+// gone, so this only flushes the CSV trace and prints the statistics.
+static void printProfile(void) {
+	profiler.closeCsv();
+	profiler.print(std::cout);
 }
 
 int main(int argc, char** argv) {
-	glutInit(&argc, argv);
-	glutInitDisplayMode(GLUT_RGB | GLUT_DOUBLE | GLUT_DEPTH);
-	glutInitWindowSize(800, 600);
-	glutCreateWindow("Final Project");
-	glutIdleFunc(&update);
-	glutDisplayFunc(&render);
-	glutReshapeFunc(&reshape);
-	glutKeyboardFunc(&keyboard);
-
-	glewInit();
-	if (!GLEW_VERSION_2_0) {
-		std::cerr << "OpenGL 2.0 not available" << std::endl;
+	startTime = std::chrono::high_resolution_clock::now();
+
+	unsigned int headlessFrames = 0;
+	std::string framePrefix;
+	std::string profileCsv;
+	bool syncAssets = false;
+	bool asyncAssets = false;
+
+	// GLUT options are ignored here, and taken by glutInit when there is a window
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-disks") == 0 && i + 1 < argc) {
+			numDisks = glm::clamp(atoi(argv[++i]), 1, 63);
+		}
+		else if (strcmp(argv[i], "-time-scale") == 0 && i + 1 < argc) {
+			simulationClock.setTimeScale(glm::clamp(atof(argv[++i]), 0.1, 1000.0));
+		}
+		else if (strcmp(argv[i], "-headless") == 0 && i + 1 < argc) {
+			headlessFrames = glm::max(atoi(argv[++i]), 1);
+		}
+		else if (strcmp(argv[i], "-save-frames") == 0 && i + 1 < argc) {
+			framePrefix = argv[++i];
+		}
+		else if (strcmp(argv[i], "-profile-csv") == 0 && i + 1 < argc) {
+			profileCsv = argv[++i];
+		}
+		else if (strcmp(argv[i], "-mip-filter") == 0 && i + 1 < argc) {
+			int filter = MipmapGenerator::parseFilter(argv[++i]);
+			if (filter < 0) {
+				std::cerr << "Unknown mip filter " << argv[i] << ", expected box or kaiser" << std::endl;
+				return 1;
+			}
+			mipFilter = filter;
+		}
+		else if (strcmp(argv[i], "-texture-budget") == 0 && i + 1 < argc) {
+			textureStreamBudget = (size_t)glm::max(atoi(argv[++i]), 0) * 1024;
+		}
+		else if (strcmp(argv[i], "-no-texture-compression") == 0) {
+			textureCompression = false;
+		}
+		else if (strcmp(argv[i], "-sync-assets") == 0) {
+			syncAssets = true;
+		}
+		else if (strcmp(argv[i], "-async-assets") == 0) {
+			asyncAssets = true;
+		}
+	}
+
+	HeadlessContext headlessContext;
+	if (headlessFrames > 0) {
+		if (!headlessContext.open()) {
+			return 1;
+		}
+	}
+	else {
+		glutInit(&argc, argv);
+		glutInitDisplayMode(GLUT_RGB | GLUT_DOUBLE | GLUT_DEPTH);
+		glutInitWindowSize(800, 600);
+		glutCreateWindow("Final Project");
+		glutIdleFunc(&update);
+		glutDisplayFunc(&render);
+		glutReshapeFunc(&reshape);
+		glutKeyboardFunc(&keyboard);
+#ifdef FREEGLUT
+		glutCloseFunc(&closeWindow);
+#endif
+	}
+
+	// without a window GLEW finds no GLX display, but the GL entry points are loaded first
+	GLenum glewStatus = glewInit();
+	if (glewStatus != GLEW_OK && !(headlessFrames > 0 && glewStatus == GLEW_ERROR_NO_GLX_DISPLAY)) {
+		std::cerr << "GLEW failed: " << glewGetErrorString(glewStatus) << std::endl;
+		return 1;
+	}
+	if (!GLEW_VERSION_3_3) {
+		std::cerr << "OpenGL 3.3 not available" << std::endl;
 		return 1;
 	}
 	std::cout << "Using GLEW " << glewGetString(GLEW_VERSION) << std::endl;
@@ -678,14 +1118,72 @@ int main(int argc, char** argv) {
 
 	programId = program.getProgramId();
 
+	locations.viewProjection = program.getUniformLocation("u_viewProjection");
+	locations.lightPosDir = program.getUniformLocation("u_lightPosDir");
+	locations.textured = program.getUniformLocation("u_textured");
+	locations.texture = program.getUniformLocation("u_texture");
+	locations.position = program.getAttribLocation("position");
+	locations.textureCoords = program.getAttribLocation("textureCoords");
+	locations.normal = program.getAttribLocation("normal");
+	locations.instanceModel = program.getAttribLocation("instanceModel");
+	locations.instanceColor = program.getAttribLocation("instanceColor");
+
+	ShaderProgram skyboxProgram;
+	skyboxProgram.loadShaders("shaders/skybox_vertex.glsl", "shaders/skybox_fragment.glsl");
 
-	createGeometry("meshes/skybox.obj", skyboxBuffers, skyboxNumVertices);
+	skyboxProgramId = skyboxProgram.getProgramId();
+
+	skyboxLocations.modelView = skyboxProgram.getUniformLocation("u_MVMatrix");
+	skyboxLocations.projection = skyboxProgram.getUniformLocation("u_PMatrix");
+	skyboxLocations.textureSampler = skyboxProgram.getUniformLocation("u_TextureSampler");
+	skyboxLocations.position = skyboxProgram.getAttribLocation("position");
+
+	// filter across the edges between cube map faces, so they do not show as seams
+	glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
 
 	initMeshes();
 
-	glutMainLoop();
+	textures.setStreamBudget(textureStreamBudget);
+	assets = new AssetManager();
+	loadAssets();
+
+	// -sync-assets waits for everything before the first frame, as loading used to.
+	// Headless runs also finish streaming, so every frame shows the loaded sky however
+	// the workers and the disk are timed; -async-assets loads in the background there
+	// too, to measure the time to the first frame.
+	bool headlessSync = headlessFrames > 0 && !asyncAssets;
+	if (syncAssets || headlessSync) {
+		assets->finish();
+		while (headlessSync && textures.getNumStreaming() > 0) {
+			textures.update();
+		}
+		std::cout << "All assets loaded after " << millisecondsSinceStart() << " ms" << std::endl;
+	}
+
+	// GL_TIME_ELAPSED queries are core in 3.3; the statistics are printed however the
+	// program exits, as GLUT may leave through exit()
+	profiler.init(true);
+	if (!profileCsv.empty() && !profiler.openCsv(profileCsv)) {
+		std::cerr << "Could not write " << profileCsv << std::endl;
+	}
+	atexit(&printProfile);
+
+	if (headlessFrames > 0) {
+		if (!headlessContext.createFramebuffer(800, 600)) {
+			return 1;
+		}
+		reshape(800, 600);
+
+		runHeadless(headlessContext, headlessFrames, framePrefix);
+	}
+	else {
+		glutMainLoop();
+	}
 
+	profiler.close();
+	delete assets;
 	cleanupMeshes();
+	headlessContext.close();
 
 	return 0;
 }
@@ -1,11 +1,11 @@
 #version 330
 
-uniform vec3 u_color; // RGB
 uniform vec4 u_lightPosDir; // W component is 'boolean'
 
 in vec3 surfaceNormal;
 in vec3 worldPosition;
 in vec2 textureCoordinates;
+in vec3 surfaceColor; // RGB
 
 uniform int u_textured;
 uniform sampler2D u_texture;
@@ -29,8 +29,8 @@ void main() {
 		 // LAMBERT 
 		float diffuse = max(0.0f, dot(normal, lightDirection));
 
-		gl_FragColor = vec4(u_color * diffuse, 1.0);
-		//gl_FragColor = vec4(u_color, 1.0);
+		gl_FragColor = vec4(surfaceColor * diffuse, 1.0);
+		//gl_FragColor = vec4(surfaceColor, 1.0);
 	}
 
 	if (u_textured == 1){
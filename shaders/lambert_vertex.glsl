@@ -1,16 +1,22 @@
 #version 330
-uniform mat4 u_MVP;
+uniform mat4 u_viewProjection;
 
 attribute vec4 position;
 attribute vec2 textureCoords;
 attribute vec3 normal;
 
+// per-instance, see InstanceData in main.cpp
+attribute mat4 instanceModel;
+attribute vec3 instanceColor;
+
 out vec3 surfaceNormal;
 out vec3 worldPosition;
 out vec2 textureCoordinates;
+out vec3 surfaceColor;
 
 void main() {
-    gl_Position = u_MVP * position;
+    gl_Position = u_viewProjection * instanceModel * position;
+    surfaceColor = instanceColor;
 
     worldPosition = gl_Position.xyz;
     surfaceNormal = normal;
@@ -1,3 +1,4 @@
+#version 330
 varying vec3 v_TexCoords;
 
 uniform samplerCube u_TextureSampler;
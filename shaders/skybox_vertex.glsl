@@ -1,3 +1,4 @@
+#version 330
 attribute vec3 position;
 
 varying vec3 v_TexCoords;
@@ -10,6 +11,7 @@ void main() {
 
    mat4 rotationMatrix = mat4(mat3(u_MVMatrix));
 
-   gl_Position = u_PMatrix * rotationMatrix * vec4(position, 1.0);
+   // z = w puts the sky on the far plane, behind everything drawn before it
+   gl_Position = (u_PMatrix * rotationMatrix * vec4(position, 1.0)).xyww;
 
 }
\ No newline at end of file
@@ -0,0 +1,187 @@
+#include "GlStub.h"
+
+#include <vector>
+
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+#include <EGL/egl.h>
+
+unsigned int glStubCalls = 0;
+
+static GLuint nextName = 1;
+
+// Does nothing but count, whatever the entry point's signature
+template <typename F> struct GlStub;
+template <typename R, typename... Args> struct GlStub<R (GLAPIENTRY *)(Args...)> {
+	static R GLAPIENTRY call(Args...) {
+		glStubCalls++;
+		return R();
+	}
+};
+
+#define GL_STUB(name) decltype(__glew##name) __glew##name = GlStub<decltype(__glew##name)>::call
+
+// Entry points that have to hand something back
+static void GLAPIENTRY genNames(GLsizei n, GLuint *names) {
+	glStubCalls++;
+	for (GLsizei i = 0; i < n; i++) {
+		names[i] = nextName++;
+	}
+}
+
+static GLuint GLAPIENTRY createName() {
+	glStubCalls++;
+	return nextName++;
+}
+
+static GLuint GLAPIENTRY createShader(GLenum) {
+	glStubCalls++;
+	return nextName++;
+}
+
+static void GLAPIENTRY getObjectiv(GLuint, GLenum pname, GLint *params) {
+	glStubCalls++;
+	*params = pname == GL_COMPILE_STATUS || pname == GL_LINK_STATUS || pname == GL_VALIDATE_STATUS ? GL_TRUE : 0;
+}
+
+static void GLAPIENTRY getQueryObjectuiv(GLuint, GLenum pname, GLuint *params) {
+	glStubCalls++;
+	*params = pname == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0;
+}
+
+static GLenum GLAPIENTRY checkFramebufferStatus(GLenum) {
+	glStubCalls++;
+	return GL_FRAMEBUFFER_COMPLETE;
+}
+
+static void* GLAPIENTRY mapBufferRange(GLenum, GLintptr, GLsizeiptr length, GLbitfield) {
+	static std::vector<unsigned char> mapped;
+	glStubCalls++;
+	mapped.resize(length);
+	return mapped.data();
+}
+
+static GLboolean GLAPIENTRY unmapBuffer(GLenum) {
+	glStubCalls++;
+	return GL_TRUE;
+}
+
+GLboolean __GLEW_VERSION_3_3 = GL_TRUE;
+GLboolean __GLEW_EXT_texture_compression_s3tc = GL_TRUE;
+
+GL_STUB(ActiveTexture);
+GL_STUB(AttachShader);
+GL_STUB(BeginQuery);
+GL_STUB(BindBuffer);
+GL_STUB(BindFramebuffer);
+GL_STUB(BindRenderbuffer);
+GL_STUB(BindVertexArray);
+GL_STUB(BufferData);
+GL_STUB(BufferSubData);
+GL_STUB(CompileShader);
+GL_STUB(CompressedTexImage2D);
+GL_STUB(CompressedTexSubImage2D);
+GL_STUB(DeleteBuffers);
+GL_STUB(DeleteFramebuffers);
+GL_STUB(DeleteQueries);
+GL_STUB(DeleteRenderbuffers);
+GL_STUB(DeleteShader);
+GL_STUB(DeleteVertexArrays);
+GL_STUB(DetachShader);
+GL_STUB(DrawElementsInstanced);
+GL_STUB(EnableVertexAttribArray);
+GL_STUB(EndQuery);
+GL_STUB(FramebufferRenderbuffer);
+GL_STUB(GetActiveAttrib);
+GL_STUB(GetActiveUniform);
+GL_STUB(GetAttribLocation);
+GL_STUB(GetProgramInfoLog);
+GL_STUB(GetQueryObjectui64v);
+GL_STUB(GetShaderInfoLog);
+GL_STUB(GetUniformLocation);
+GL_STUB(LinkProgram);
+GL_STUB(RenderbufferStorage);
+GL_STUB(ShaderSource);
+GL_STUB(Uniform1i);
+GL_STUB(Uniform4fv);
+GL_STUB(UniformMatrix4fv);
+GL_STUB(UseProgram);
+GL_STUB(ValidateProgram);
+GL_STUB(VertexAttribDivisor);
+GL_STUB(VertexAttribPointer);
+
+PFNGLGENBUFFERSPROC __glewGenBuffers = genNames;
+PFNGLGENFRAMEBUFFERSPROC __glewGenFramebuffers = genNames;
+PFNGLGENQUERIESPROC __glewGenQueries = genNames;
+PFNGLGENRENDERBUFFERSPROC __glewGenRenderbuffers = genNames;
+PFNGLGENVERTEXARRAYSPROC __glewGenVertexArrays = genNames;
+PFNGLCREATEPROGRAMPROC __glewCreateProgram = createName;
+PFNGLCREATESHADERPROC __glewCreateShader = createShader;
+PFNGLGETPROGRAMIVPROC __glewGetProgramiv = getObjectiv;
+PFNGLGETSHADERIVPROC __glewGetShaderiv = getObjectiv;
+PFNGLGETQUERYOBJECTUIVPROC __glewGetQueryObjectuiv = getQueryObjectuiv;
+PFNGLCHECKFRAMEBUFFERSTATUSPROC __glewCheckFramebufferStatus = checkFramebufferStatus;
+PFNGLMAPBUFFERRANGEPROC __glewMapBufferRange = mapBufferRange;
+PFNGLUNMAPBUFFERPROC __glewUnmapBuffer = unmapBuffer;
+
+// GL 1.1, which GLEW leaves to the GL library
+void GLAPIENTRY glBindTexture(GLenum, GLuint) { glStubCalls++; }
+void GLAPIENTRY glClear(GLbitfield) { glStubCalls++; }
+void GLAPIENTRY glDeleteTextures(GLsizei, const GLuint*) { glStubCalls++; }
+void GLAPIENTRY glDepthFunc(GLenum) { glStubCalls++; }
+void GLAPIENTRY glDepthMask(GLboolean) { glStubCalls++; }
+void GLAPIENTRY glDrawArrays(GLenum, GLint, GLsizei) { glStubCalls++; }
+void GLAPIENTRY glEnable(GLenum) { glStubCalls++; }
+void GLAPIENTRY glFinish(void) { glStubCalls++; }
+void GLAPIENTRY glGenTextures(GLsizei n, GLuint *textures) { genNames(n, textures); }
+void GLAPIENTRY glPixelStorei(GLenum, GLint) { glStubCalls++; }
+void GLAPIENTRY glReadPixels(GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, void*) { glStubCalls++; }
+void GLAPIENTRY glTexImage2D(GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const void*) { glStubCalls++; }
+void GLAPIENTRY glTexParameteri(GLenum, GLenum, GLint) { glStubCalls++; }
+void GLAPIENTRY glTexSubImage2D(GLenum, GLint, GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, const void*) { glStubCalls++; }
+void GLAPIENTRY glViewport(GLint, GLint, GLsizei, GLsizei) { glStubCalls++; }
+
+const GLubyte* GLAPIENTRY glGetString(GLenum) {
+	glStubCalls++;
+	return (const GLubyte*)"stub";
+}
+
+GLenum GLEWAPIENTRY glewInit(void) {
+	return GLEW_OK;
+}
+
+const GLubyte* GLEWAPIENTRY glewGetString(GLenum) {
+	return (const GLubyte*)"stub";
+}
+
+const GLubyte* GLEWAPIENTRY glewGetErrorString(GLenum) {
+	return (const GLubyte*)"stub";
+}
+
+// No window system: GLUT does nothing and EGL has no display
+void GLAPIENTRY glutInit(int*, char**) {}
+void GLAPIENTRY glutInitDisplayMode(unsigned int) {}
+void GLAPIENTRY glutInitWindowSize(int, int) {}
+int GLAPIENTRY glutCreateWindow(const char*) { return 1; }
+void GLAPIENTRY glutIdleFunc(void (*)(void)) {}
+void GLAPIENTRY glutDisplayFunc(void (*)(void)) {}
+void GLAPIENTRY glutReshapeFunc(void (*)(int, int)) {}
+void GLAPIENTRY glutKeyboardFunc(void (*)(unsigned char, int, int)) {}
+void GLAPIENTRY glutCloseFunc(void (*)(void)) {}
+void GLAPIENTRY glutMainLoop(void) {}
+void GLAPIENTRY glutPostRedisplay(void) {}
+void GLAPIENTRY glutSetWindowTitle(const char*) {}
+void GLAPIENTRY glutSwapBuffers(void) {}
+int GLAPIENTRY glutGet(GLenum) { return 0; }
+
+EGLDisplay EGLAPIENTRY eglGetDisplay(EGLNativeDisplayType) { return EGL_NO_DISPLAY; }
+__eglMustCastToProperFunctionPointerType EGLAPIENTRY eglGetProcAddress(const char*) { return nullptr; }
+EGLBoolean EGLAPIENTRY eglInitialize(EGLDisplay, EGLint*, EGLint*) { return EGL_FALSE; }
+EGLBoolean EGLAPIENTRY eglChooseConfig(EGLDisplay, const EGLint*, EGLConfig*, EGLint, EGLint*) { return EGL_FALSE; }
+EGLBoolean EGLAPIENTRY eglBindAPI(EGLenum) { return EGL_FALSE; }
+EGLContext EGLAPIENTRY eglCreateContext(EGLDisplay, EGLConfig, EGLContext, const EGLint*) { return EGL_NO_CONTEXT; }
+EGLSurface EGLAPIENTRY eglCreatePbufferSurface(EGLDisplay, EGLConfig, const EGLint*) { return EGL_NO_SURFACE; }
+EGLBoolean EGLAPIENTRY eglMakeCurrent(EGLDisplay, EGLSurface, EGLSurface, EGLContext) { return EGL_FALSE; }
+EGLBoolean EGLAPIENTRY eglDestroySurface(EGLDisplay, EGLSurface) { return EGL_FALSE; }
+EGLBoolean EGLAPIENTRY eglDestroyContext(EGLDisplay, EGLContext) { return EGL_FALSE; }
+EGLBoolean EGLAPIENTRY eglTerminate(EGLDisplay) { return EGL_FALSE; }
@@ -0,0 +1,11 @@
+#pragma once
+
+// A GL, GLEW, GLUT and EGL that draw nothing, for tests that run the renderer without
+// a display or a GL library. Every GL call through it is counted; GLUT and EGL calls
+// are not. Names come back from glGen* and glCreate*, shaders always compile and
+// link, and everything else returns zero.
+//
+// Link tests with GlStub.o in place of -lGL -lGLEW -lglut -lEGL.
+
+// GL calls made since the last reset
+extern unsigned int glStubCalls;
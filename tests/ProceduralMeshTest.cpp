@@ -0,0 +1,151 @@
+// Generates each procedural primitive and checks the mesh it builds: vertex and triangle
+// counts, indices in range, no degenerate triangles, unit normals, front faces wound
+// counter-clockwise as seen from outside, a closed surface of the expected volume, and
+// for the round shapes every vertex on the surface with its normal across it.
+//
+//   ./procedural_mesh_test        (exits 1 on a failure)
+
+#include "../Box.h"
+#include "../Capsule.h"
+#include "../UVCylinder.h"
+#include "../UVSphere.h"
+#include "../UVTorus.h"
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <string>
+
+#include <glm/glm.hpp>
+
+static int failures = 0;
+
+static void check(bool passed, const std::string &what) {
+	std::cout << (passed ? "ok   " : "FAIL ") << what << std::endl;
+	if (!passed) {
+		failures++;
+	}
+}
+
+// The nearest point of the shape's core (a point, segment or circle) to a position, for
+// shapes that are the points at a fixed distance from it
+typedef std::function<glm::vec3(const glm::vec3&)> CoreFunction;
+
+static void checkMesh(const std::string &name, ProceduralMesh &mesh, unsigned int numVertices, unsigned int numTriangles,
+	double volume, double volumeTolerance, CoreFunction core = CoreFunction(), float coreDistance = 0.0f) {
+	check(mesh.getNumVertices() == numVertices, name + ": " + std::to_string(mesh.getNumVertices()) + " vertices, expected " + std::to_string(numVertices));
+	check(mesh.getNumTriangles() == numTriangles, name + ": " + std::to_string(mesh.getNumTriangles()) + " triangles, expected " + std::to_string(numTriangles));
+
+	const glm::vec3* positions = mesh.getPositions();
+	const glm::vec3* normals = mesh.getNormals();
+	const unsigned int* indices = mesh.getTriangleIndices();
+
+	bool inRange = true;
+	bool degenerate = false;
+	bool wound = true;
+	double signedVolume = 0.0;
+	for (unsigned int t = 0; t < mesh.getNumTriangles() && inRange; t++) {
+		const unsigned int* triangle = &indices[t * 3];
+		if (triangle[0] >= numVertices || triangle[1] >= numVertices || triangle[2] >= numVertices) {
+			inRange = false;
+			break;
+		}
+
+		glm::vec3 a = positions[triangle[0]], b = positions[triangle[1]], c = positions[triangle[2]];
+		glm::vec3 faceNormal = glm::cross(b - a, c - a);
+		degenerate = degenerate || glm::length(faceNormal) < 1e-9f;
+		wound = wound && glm::dot(faceNormal, normals[triangle[0]] + normals[triangle[1]] + normals[triangle[2]]) > 0.0f;
+
+		// the divergence theorem, one tetrahedron to the origin per triangle
+		signedVolume += glm::dot(a, glm::cross(b, c)) / 6.0;
+	}
+	check(inRange, name + ": indices are all in range");
+	check(!degenerate, name + ": no triangle is degenerate");
+	check(wound, name + ": triangles face the way their normals do");
+	check(fabs(signedVolume - volume) <= volume * volumeTolerance,
+		name + ": encloses a volume of " + std::to_string(signedVolume) + ", expected " + std::to_string(volume));
+
+	float maxNormalError = 0.0f;
+	float maxSurfaceError = 0.0f;
+	float maxDirectionError = 0.0f;
+	for (unsigned int i = 0; i < numVertices; i++) {
+		maxNormalError = std::max(maxNormalError, fabsf(glm::length(normals[i]) - 1.0f));
+
+		if (core) {
+			glm::vec3 outward = positions[i] - core(positions[i]);
+			maxSurfaceError = std::max(maxSurfaceError, fabsf(glm::length(outward) - coreDistance));
+			maxDirectionError = std::max(maxDirectionError, glm::length(normals[i] - outward / coreDistance));
+		}
+	}
+	check(maxNormalError < 1e-5f, name + ": normals are unit length");
+	if (core) {
+		check(maxSurfaceError < 1e-5f, name + ": vertices lie on the surface");
+		check(maxDirectionError < 1e-5f, name + ": normals point straight out of it");
+	}
+}
+
+static void checkSphere() {
+	const float radius = 0.75f;
+	const unsigned int numSlices = 32, numStacks = 16;
+	UVSphere sphere(radius, numSlices, numStacks);
+
+	// the rows at the poles are fans, one triangle per slice
+	checkMesh("sphere", sphere, (numStacks + 1) * (numSlices + 1), 2 * numSlices * (numStacks - 1),
+		4.0 / 3.0 * M_PI * radius * radius * radius, 0.02,
+		[](const glm::vec3&) { return glm::vec3(0.0f); }, radius);
+}
+
+static void checkCapsule() {
+	const float radius = 0.5f, height = 1.5f;
+	const unsigned int numSegments = 32, numRings = 8;
+	Capsule capsule(radius, height, numSegments, numRings);
+
+	// two hemispheres of numRings rows each, less a fan at each pole, and the side between
+	float halfHeight = height * 0.5f;
+	checkMesh("capsule", capsule, 2 * (numRings + 1) * (numSegments + 1), 2 * numSegments * (2 * numRings + 1) - 2 * numSegments,
+		M_PI * radius * radius * (height + 4.0 / 3.0 * radius), 0.02,
+		[halfHeight](const glm::vec3 &p) { return glm::vec3(0.0f, glm::clamp(p.y, -halfHeight, halfHeight), 0.0f); }, radius);
+}
+
+static void checkTorus() {
+	const float ringRadius = 1.0f, tubeRadius = 0.25f;
+	const unsigned int ringSegments = 48, tubeSegments = 16;
+	UVTorus torus(ringRadius, tubeRadius, ringSegments, tubeSegments);
+
+	checkMesh("torus", torus, (ringSegments + 1) * (tubeSegments + 1), 2 * ringSegments * tubeSegments,
+		2.0 * M_PI * M_PI * ringRadius * tubeRadius * tubeRadius, 0.03,
+		[ringRadius](const glm::vec3 &p) { return glm::normalize(glm::vec3(p.x, 0.0f, p.z)) * ringRadius; }, tubeRadius);
+}
+
+static void checkCylinder() {
+	const float radius = 0.5f, height = 2.0f;
+	const unsigned int numSegments = 12;
+	UVCylinder cylinder(radius, numSegments, height);
+
+	// two fanned caps and the side, each with its own rim; a prism's volume exactly
+	checkMesh("cylinder", cylinder, 3 * 2 * (numSegments + 1), 4 * numSegments,
+		numSegments * 0.5 * sin(2.0 * M_PI / numSegments) * radius * radius * height, 1e-5);
+}
+
+static void checkBox() {
+	Box box(1.0f, 2.0f, 3.0f);
+	checkMesh("box", box, 24, 12, 6.0, 1e-5);
+}
+
+int main(int argc, char** argv) {
+	checkSphere();
+	checkCapsule();
+	checkTorus();
+	checkCylinder();
+	checkBox();
+
+	if (failures > 0) {
+		std::cout << failures << " checks failed" << std::endl;
+		return 1;
+	}
+	std::cout << "All checks passed" << std::endl;
+	return 0;
+}
@@ -0,0 +1,92 @@
+// Renders the default scene against the stub GL layer and checks the GL calls a
+// frame makes: COUNT_GL has to see every one, and their number is pinned, so a
+// change that adds calls per mesh or per batch shows up here. Then plays out the
+// last move and steps back from the solved state.
+//
+//   ./render_test        (exits 1 on a failure)
+
+#define main hanoiMain
+#include "../main.cpp"
+#undef main
+
+#include "GlStub.h"
+
+static int failures = 0;
+
+static void check(bool passed, const std::string &what) {
+	std::cout << (passed ? "ok   " : "FAIL ") << what << std::endl;
+	if (!passed) {
+		failures++;
+	}
+}
+
+// Renders one frame and checks the calls it made
+static void checkFrame(int timeMs, unsigned int expectedCalls) {
+	updateScene(timeMs);
+
+	glStubCalls = 0;
+	renderScene();
+
+	std::string frame = "frame at " + std::to_string(timeMs) + " ms: ";
+	check(glCallsLastFrame == glStubCalls, frame + std::to_string(glStubCalls) + " GL calls, COUNT_GL saw " + std::to_string(glCallsLastFrame));
+	check(glCallsLastFrame == expectedCalls, frame + std::to_string(glCallsLastFrame) + " GL calls, expected " + std::to_string(expectedCalls));
+}
+
+// Animates the last move to the end, then takes it back with ','
+static void checkStepBackWhenSolved() {
+	unsigned long long numMoves = solver->getNumMoves();
+	seekToMove(numMoves - 1);
+
+	int timeMs = 1000;
+	for (int frame = 0; frame < 600 && animating; frame++) {
+		updateScene(timeMs);
+		timeMs += 1000 / 60;
+	}
+	check(!animating && solver->getMovesMade() == numMoves, "the last move plays out to the solved state");
+
+	keyboard(',', 0, 0);
+	check(solver->getMovesMade() == numMoves - 1, "',' from the solved state steps back one move, to " + std::to_string(solver->getMovesMade()));
+}
+
+int main(int argc, char** argv) {
+	glewInit();
+
+	// as the shaders would lay them out
+	locations.viewProjection = 0;
+	locations.lightPosDir = 1;
+	locations.textured = 2;
+	locations.texture = 3;
+	locations.position = 0;
+	locations.textureCoords = 1;
+	locations.normal = 2;
+	locations.instanceModel = 3;
+	locations.instanceColor = 7;
+	skyboxLocations.modelView = 0;
+	skyboxLocations.projection = 1;
+	skyboxLocations.textureSampler = 2;
+	skyboxLocations.position = 0;
+
+	initMeshes();
+	assets = new AssetManager();
+	reshape(800, 600);
+
+	// 7 shared state calls, per batch a bind and fill of the instance buffer, the
+	// textured flag, the vertex array and the draw, then 11 for the sky and 1 to
+	// unbind: base, poles and the disks, which share one torus but at this distance
+	// not one level of detail, so 4 batches. The first frame also allocates each
+	// batch's instance buffer; later ones reuse it.
+	checkFrame(0, 7 + 4 * 6 + 11 + 1);
+	checkFrame(1000 / 60, 7 + 4 * 5 + 11 + 1);
+
+	checkStepBackWhenSolved();
+
+	delete assets;
+	cleanupMeshes();
+
+	if (failures > 0) {
+		std::cout << failures << " checks failed" << std::endl;
+		return 1;
+	}
+	std::cout << "All checks passed" << std::endl;
+	return 0;
+}
@@ -0,0 +1,128 @@
+// Drives SimulationClock by hand, checking the steps it hands out, the blend factor
+// left over and how time scale, pausing and the step cap change them; then chains
+// animations on it the way main.cpp chains Hanoi moves.
+//
+//   ./simulation_clock_test        (exits 1 on a failure)
+
+#include "../SimulationClock.h"
+#include "../Animation.h"
+
+#include <cmath>
+#include <iostream>
+#include <string>
+
+static int failures = 0;
+
+static void check(bool passed, const std::string &what) {
+	std::cout << (passed ? "ok   " : "FAIL ") << what << std::endl;
+	if (!passed) {
+		failures++;
+	}
+}
+
+static unsigned int countSteps(SimulationClock &clock) {
+	unsigned int steps = 0;
+	while (clock.step()) {
+		steps++;
+	}
+	return steps;
+}
+
+static bool near(double a, double b) {
+	return fabs(a - b) < 1e-6;
+}
+
+static void checkSteps() {
+	SimulationClock clock(10);
+
+	clock.advance(25.0);
+	check(countSteps(clock) == 2, "25 ms at 10 ms steps is 2 steps");
+	check(near(clock.getAlpha(), 0.5), "and leaves half a step");
+	check(clock.getTimeMs() == 20, "and moves the time on 20 ms");
+
+	clock.advance(5.0);
+	check(countSteps(clock) == 1, "the leftover carries into the next advance");
+	check(near(clock.getAlpha(), 0.0), "and is used up by it");
+
+	clock.advance(0.0);
+	clock.advance(-10.0);
+	check(countSteps(clock) == 0 && clock.getTimeMs() == 30, "no time, or time going back, makes no steps");
+}
+
+static void checkTimeScale() {
+	SimulationClock clock(10);
+
+	clock.setTimeScale(2.0);
+	clock.advance(25.0);
+	check(countSteps(clock) == 5, "25 ms at 2x is 5 steps");
+	check(clock.getTimeMs() == 50, "and 50 ms of simulation");
+
+	clock.setTimeScale(0.5);
+	clock.advance(25.0);
+	check(countSteps(clock) == 1, "25 ms at 0.5x is 1 step");
+	check(near(clock.getAlpha(), 0.25), "and leaves a quarter of a step");
+
+	clock.setTimeScale(-1.0);
+	check(clock.getTimeScale() == 0.0, "a negative time scale stops time");
+	clock.advance(100.0);
+	check(countSteps(clock) == 0, "and makes no steps");
+}
+
+static void checkPauseAndCap() {
+	SimulationClock clock(10);
+
+	clock.setPaused(true);
+	clock.advance(100.0);
+	check(countSteps(clock) == 0, "a paused clock makes no steps");
+	clock.setPaused(false);
+
+	clock.setMaxStepsPerAdvance(3);
+	clock.advance(1000.0);
+	check(countSteps(clock) == 3, "a stall is capped at the steps allowed per advance");
+	check(near(clock.getAlpha(), 0.0), "with nothing left over");
+	check(clock.getTimeMs() == 30, "so the simulation falls behind rather than jumping");
+}
+
+// Runs back to back 105 ms moves for a second of real time at stepMs steps, starting
+// each when the one before ended. Returns how many finished.
+static unsigned int countMoves(unsigned int stepMs) {
+	SimulationClock clock(stepMs);
+	Animation move({ Frame(glm::vec3(0.0f), 0), Frame(glm::vec3(1.0f), 105) });
+	move.Reset(0);
+
+	unsigned int moves = 0;
+	for (int frame = 0; frame < 60; frame++) {
+		clock.advance(1000.0 / 60.0);
+		while (clock.step()) {
+			glm::mat4 transform(1.0f);
+			move.Update(clock.getTimeMs(), transform);
+			if (!move.IsAnimating()) {
+				moves++;
+				move.Reset(move.GetEndTime());
+			}
+		}
+	}
+	return moves;
+}
+
+static void checkMoveChaining() {
+	// a move is only seen to end at the first step after it, so starting the next at
+	// the step would lose up to a step per move; 1 s holds 9 whole moves either way
+	check(countMoves(10) == 9, "9 moves of 105 ms finish in 1 s at 10 ms steps");
+	check(countMoves(7) == 9, "and at 7 ms steps");
+	check(countMoves(50) == 9, "and at 50 ms steps");
+}
+
+int main(int argc, char** argv) {
+	checkSteps();
+	checkTimeScale();
+	checkPauseAndCap();
+	checkMoveChaining();
+
+	if (failures > 0) {
+		std::cout << failures << " checks failed" << std::endl;
+		return 1;
+	}
+	std::cout << "All checks passed" << std::endl;
+	return 0;
+}
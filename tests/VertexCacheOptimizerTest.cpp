@@ -0,0 +1,173 @@
+// Checks getAcmr on FIFO cases small enough to count by hand, since the ratios meshconv
+// reports (and the reordering is judged by) come from it; then that reordering a
+// shuffled grid keeps its triangles and windings, lowers the miss ratio, renumbers the
+// vertices in first use order, and gives the same result when first run on several
+// threads at once, as the asset workers do.
+//
+//   ./vertex_cache_optimizer_test        (exits 1 on a failure)
+
+#include "../VertexCacheOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static int failures = 0;
+
+static void check(bool passed, const std::string &what) {
+	std::cout << (passed ? "ok   " : "FAIL ") << what << std::endl;
+	if (!passed) {
+		failures++;
+	}
+}
+
+static void checkAcmr(const std::string &what, const std::vector<unsigned int> &indices, unsigned int numVertices, unsigned int cacheSize, float expected) {
+	float acmr = VertexCacheOptimizer::getAcmr(indices.data(), indices.size() / 3, numVertices, cacheSize);
+	check(fabsf(acmr - expected) < 1e-6f, what + ": " + std::to_string(acmr) + ", expected " + std::to_string(expected));
+}
+
+static void checkAcmrCases() {
+	// 3 misses fill a 3-entry FIFO and the second copy hits all of them
+	checkAcmr("same triangle twice, 3 entries", { 0, 1, 2, 0, 1, 2 }, 3, 3, 1.5f);
+	// one miss, then a single entry is enough for the other five
+	checkAcmr("one vertex repeated, 1 entry", { 0, 0, 0, 0, 0, 0 }, 1, 1, 0.5f);
+	checkAcmr("no shared vertices", { 0, 1, 2, 3, 4, 5 }, 6, 16, 3.0f);
+	// 3 more misses push the first triangle's vertices out before it comes round again
+	checkAcmr("a triangle evicted before its repeat, 3 entries", { 0, 1, 2, 3, 4, 5, 0, 1, 2 }, 6, 3, 3.0f);
+	// a hit does not move a vertex to the back, as it would in an LRU cache: vertex 0 is
+	// evicted after 3, 4 and 5 missed even though it was hit in between
+	checkAcmr("hits do not refresh an entry, 3 entries", { 0, 1, 2, 0, 3, 4, 0, 5, 6 }, 7, 3, 8.0f / 3.0f);
+	checkAcmr("no triangles", {}, 0, 16, 0.0f);
+}
+
+// A width x height grid of quads, two triangles each, in a fixed shuffled order
+static std::vector<unsigned int> makeShuffledGrid(unsigned int width, unsigned int height) {
+	std::vector<unsigned int> indices;
+	for (unsigned int y = 0; y < height; y++) {
+		for (unsigned int x = 0; x < width; x++) {
+			unsigned int a = y * (width + 1) + x;
+			unsigned int b = a + 1;
+			unsigned int c = a + width + 1;
+			unsigned int d = c + 1;
+			indices.insert(indices.end(), { a, b, c, b, d, c });
+		}
+	}
+
+	unsigned int numTriangles = indices.size() / 3;
+	unsigned int seed = 12345;
+	for (unsigned int t = numTriangles - 1; t > 0; t--) {
+		seed = seed * 1664525u + 1013904223u;
+		unsigned int other = (seed >> 8) % (t + 1);
+		std::swap_ranges(&indices[t * 3], &indices[t * 3] + 3, &indices[other * 3]);
+	}
+	return indices;
+}
+
+// Each triangle rotated to start at its smallest index, which keeps its winding, then sorted
+static std::vector<unsigned int> canonicalTriangles(const std::vector<unsigned int> &indices) {
+	std::vector<unsigned int> triangles(indices);
+	for (size_t t = 0; t < triangles.size(); t += 3) {
+		std::rotate(&triangles[t], std::min_element(&triangles[t], &triangles[t] + 3), &triangles[t] + 3);
+	}
+
+	std::vector<std::vector<unsigned int>> sorted;
+	for (size_t t = 0; t < triangles.size(); t += 3) {
+		sorted.push_back({ triangles[t], triangles[t + 1], triangles[t + 2] });
+	}
+	std::sort(sorted.begin(), sorted.end());
+
+	triangles.clear();
+	for (const std::vector<unsigned int> &triangle : sorted) {
+		triangles.insert(triangles.end(), triangle.begin(), triangle.end());
+	}
+	return triangles;
+}
+
+static const unsigned int GRID_SIZE = 32;
+static const unsigned int GRID_VERTICES = (GRID_SIZE + 1) * (GRID_SIZE + 1);
+static const unsigned int GRID_TRIANGLES = GRID_SIZE * GRID_SIZE * 2;
+
+static void checkConcurrentFirstUse() {
+	const unsigned int numThreads = 8;
+	std::vector<std::vector<unsigned int>> results(numThreads, makeShuffledGrid(GRID_SIZE, GRID_SIZE));
+
+	// before anything else has used the optimizer, so its score tables are built here
+	std::vector<std::thread> threads;
+	for (unsigned int i = 0; i < numThreads; i++) {
+		std::vector<unsigned int> &indices = results[i];
+		threads.push_back(std::thread([&indices]() {
+			VertexCacheOptimizer::optimizeTriangleOrder(indices.data(), GRID_TRIANGLES, GRID_VERTICES);
+		}));
+	}
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+
+	std::vector<unsigned int> expected = makeShuffledGrid(GRID_SIZE, GRID_SIZE);
+	VertexCacheOptimizer::optimizeTriangleOrder(expected.data(), GRID_TRIANGLES, GRID_VERTICES);
+
+	bool same = true;
+	for (const std::vector<unsigned int> &result : results) {
+		same = same && result == expected;
+	}
+	check(same, std::to_string(numThreads) + " threads optimizing at once on first use agree with a later single run");
+}
+
+static void checkTriangleOrder() {
+	std::vector<unsigned int> original = makeShuffledGrid(GRID_SIZE, GRID_SIZE);
+	std::vector<unsigned int> indices(original);
+	VertexCacheOptimizer::optimizeTriangleOrder(indices.data(), GRID_TRIANGLES, GRID_VERTICES);
+
+	check(canonicalTriangles(indices) == canonicalTriangles(original), "reordering keeps every triangle and its winding");
+
+	float before = VertexCacheOptimizer::getAcmr(original.data(), GRID_TRIANGLES, GRID_VERTICES);
+	float after = VertexCacheOptimizer::getAcmr(indices.data(), GRID_TRIANGLES, GRID_VERTICES);
+	check(after < 1.0f && after < before, "and lowers the miss ratio of a shuffled grid, " + std::to_string(before) + " -> " + std::to_string(after));
+}
+
+static void checkVertexOrder() {
+	std::vector<unsigned int> original = makeShuffledGrid(GRID_SIZE, GRID_SIZE);
+	std::vector<unsigned int> indices(original);
+
+	// one vertex past the grid that no triangle uses
+	std::vector<unsigned int> remap;
+	unsigned int numUsed = VertexCacheOptimizer::optimizeVertexOrder(indices.data(), GRID_TRIANGLES, GRID_VERTICES + 1, remap);
+
+	check(numUsed == GRID_VERTICES && remap.size() == GRID_VERTICES + 1 && remap[GRID_VERTICES] == GRID_VERTICES + 1,
+		"every used vertex is kept and the unused one is marked for dropping");
+
+	bool remapped = true;
+	for (size_t i = 0; i < indices.size(); i++) {
+		remapped = remapped && indices[i] == remap[original[i]];
+	}
+	check(remapped, "the indices are rewritten through the remap");
+
+	unsigned int nextNew = 0;
+	bool firstUseOrder = true;
+	for (unsigned int index : indices) {
+		if (index == nextNew) {
+			nextNew++;
+		}
+		else {
+			firstUseOrder = firstUseOrder && index < nextNew;
+		}
+	}
+	check(firstUseOrder && nextNew == GRID_VERTICES, "vertices are numbered in the order the triangles first use them");
+}
+
+int main(int argc, char** argv) {
+	checkConcurrentFirstUse();
+	checkAcmrCases();
+	checkTriangleOrder();
+	checkVertexOrder();
+
+	if (failures > 0) {
+		std::cout << failures << " checks failed" << std::endl;
+		return 1;
+	}
+	std::cout << "All checks passed" << std::endl;
+	return 0;
+}
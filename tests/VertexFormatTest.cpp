@@ -0,0 +1,129 @@
+// Packs and unpacks normals and texture coordinates the way PackedVertex stores them:
+// the ends of the snorm10 range, clamping of normals that are not unit length, and
+// binary16 rounding, overflow and subnormals, including every half there is.
+//
+//   ./vertex_format_test        (exits 1 on a failure)
+
+#include "../VertexFormat.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <string>
+
+static int failures = 0;
+
+static void check(bool passed, const std::string &what) {
+	std::cout << (passed ? "ok   " : "FAIL ") << what << std::endl;
+	if (!passed) {
+		failures++;
+	}
+}
+
+static Vector3 vector3(float x, float y, float z) {
+	Vector3 v = { x, y, z };
+	return v;
+}
+
+static bool same(const Vector3 &a, const Vector3 &b) {
+	return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+static unsigned int component(unsigned int packed, int c) {
+	return (packed >> (c * 10)) & 0x3ff;
+}
+
+static void checkNormals() {
+	unsigned int packed = packNormal(vector3(1.0f, 0.0f, -1.0f));
+	check(component(packed, 0) == 0x1ff && component(packed, 1) == 0 && component(packed, 2) == 0x201 && packed >> 30 == 0,
+		"+1, 0 and -1 pack to 511, 0 and -511 with w left at zero");
+	check(same(unpackNormal(packed), vector3(1.0f, 0.0f, -1.0f)), "and unpack exactly");
+
+	// -512 is only ever read, from data packed elsewhere; GL clamps it to -1 as well
+	check(unpackNormal(0x200).x == -1.0f, "-512 unpacks to -1");
+
+	check(same(unpackNormal(packNormal(vector3(2.0f, -3.0f, 0.0f))), vector3(1.0f, -1.0f, 0.0f)),
+		"a normal longer than unit length is clamped per component");
+	check(same(unpackNormal(packNormal(vector3(0.0f, 0.0f, 0.0f))), vector3(0.0f, 0.0f, 0.0f)), "a zero normal stays zero");
+
+	float nan = std::numeric_limits<float>::quiet_NaN();
+	check(unpackNormal(packNormal(vector3(nan, 0.0f, 0.0f))).x == -1.0f, "NaN is clamped rather than packed as garbage");
+
+	// every value, halfway ones included, lands within half a step
+	float maxError = 0.0f;
+	for (int i = -2044; i <= 2044; i++) {
+		float value = i / 2044.0f;
+		float error = std::fabs(unpackNormal(packNormal(vector3(value, 0.0f, 0.0f))).x - value);
+		maxError = std::max(maxError, error);
+	}
+	check(maxError <= 0.5f / 511.0f + 1e-6f, "values across [-1, 1] round-trip within half a step, max error " + std::to_string(maxError));
+}
+
+static void checkHalfRounding() {
+	check(packHalf(1.0f) == 0x3c00 && packHalf(-1.0f) == 0xbc00, "+1 and -1 pack exactly");
+	check(packHalf(0.0f) == 0x0000 && packHalf(-0.0f) == 0x8000, "and both zeros keep their sign");
+
+	// 1 + 2^-11 is halfway between 0x3c00 and 0x3c01, 1 + 3 * 2^-11 between 0x3c01 and 0x3c02
+	check(packHalf(1.0f + std::ldexp(1.0f, -11)) == 0x3c00, "a tie rounds down to the even half");
+	check(packHalf(1.0f + 3.0f * std::ldexp(1.0f, -11)) == 0x3c02, "and up to the even half");
+	check(packHalf(1.0f + std::ldexp(1.0f, -11) + std::ldexp(1.0f, -20)) == 0x3c01, "just past a tie rounds up");
+	check(packHalf(2.0f - std::ldexp(1.0f, -12)) == 0x4000, "rounding up out of the mantissa carries into the exponent");
+}
+
+static void checkHalfRange() {
+	check(packHalf(65504.0f) == 0x7bff, "65504 is the largest half");
+	check(packHalf(65520.0f) == 0x7c00, "halfway past it rounds to infinity");
+	check(packHalf(1e6f) == 0x7c00 && packHalf(-1e6f) == 0xfc00, "out of range values become infinities");
+
+	float infinity = std::numeric_limits<float>::infinity();
+	check(packHalf(infinity) == 0x7c00 && packHalf(-infinity) == 0xfc00, "infinities stay infinities");
+	check(std::isnan(unpackHalf(packHalf(std::numeric_limits<float>::quiet_NaN()))), "NaN stays NaN");
+
+	check(packHalf(std::ldexp(1.0f, -14)) == 0x0400, "2^-14 is the smallest normal half");
+	check(packHalf(std::ldexp(1.0f, -24)) == 0x0001, "2^-24 is the smallest subnormal");
+	check(packHalf(1023.0f * std::ldexp(1.0f, -24)) == 0x03ff, "1023 * 2^-24 is the largest subnormal");
+	check(packHalf(std::ldexp(1.0f, -14) - std::ldexp(1.0f, -25)) == 0x0400, "a tie below 2^-14 rounds up into the normals");
+	check(packHalf(std::ldexp(1.0f, -25)) == 0x0000, "half the smallest subnormal ties to zero");
+	check(packHalf(3.0f * std::ldexp(1.0f, -25)) == 0x0002, "and 1.5 of it to 2");
+	check(packHalf(-std::ldexp(1.0f, -30)) == 0x8000, "too small to represent becomes a signed zero");
+}
+
+static void checkEveryHalf() {
+	unsigned int mismatches = 0;
+	for (unsigned int half = 0; half <= 0xffff; half++) {
+		bool nan = (half & 0x7c00) == 0x7c00 && (half & 0x3ff) != 0;
+		if (!nan && packHalf(unpackHalf((unsigned short)half)) != half) {
+			mismatches++;
+		}
+	}
+	check(mismatches == 0, "every half but NaN round-trips exactly, " + std::to_string(mismatches) + " do not");
+}
+
+static void checkVertex() {
+	Vertex vertex;
+	vertex.position = vector3(1.5f, -2.25f, 1e-3f);
+	vertex.normal = vector3(0.0f, 1.0f, 0.0f);
+	vertex.textureCoord.u = 0.25f;
+	vertex.textureCoord.v = 0.75f;
+
+	Vertex unpacked = unpackVertex(packVertex(vertex));
+	check(same(unpacked.position, vertex.position) && same(unpacked.normal, vertex.normal) &&
+		unpacked.textureCoord.u == 0.25f && unpacked.textureCoord.v == 0.75f,
+		"a vertex with exactly representable values round-trips exactly");
+}
+
+int main(int argc, char** argv) {
+	checkNormals();
+	checkHalfRounding();
+	checkHalfRange();
+	checkEveryHalf();
+	checkVertex();
+
+	if (failures > 0) {
+		std::cout << failures << " checks failed" << std::endl;
+		return 1;
+	}
+	std::cout << "All checks passed" << std::endl;
+	return 0;
+}
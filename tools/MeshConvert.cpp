@@ -0,0 +1,160 @@
+// Builds the binary mesh caches (see MeshCache.h) ahead of time, so the first
+// launch does not have to parse any .obj text either.
+//
+//   ./meshconv [-no-centre] [-no-normalize] [-no-optimize] meshes/*.obj
+//   ./meshconv -simplify 2000 meshes/skybox.obj      (writes meshes/skybox_2000.obj)
+//
+// The defaults match createGeometry in main.cpp (auto-centred, normalized and
+// reordered for the vertex cache).
+// Each mesh is also checked to round-trip through the packed vertex layout.
+// With -simplify, a reduced copy of each mesh is written instead (see MeshSimplifier.h).
+
+#include "../ObjMesh.h"
+#include "../MeshCache.h"
+#include "../MeshSimplifier.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static double millisecondsSince(std::chrono::high_resolution_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+	bool autoCentre = true;
+	bool autoNormalize = true;
+	bool optimize = true;
+	unsigned int simplifyTriangles = 0;
+	std::vector<std::string> filenames;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-no-centre") == 0) {
+			autoCentre = false;
+		}
+		else if (strcmp(argv[i], "-no-normalize") == 0) {
+			autoNormalize = false;
+		}
+		else if (strcmp(argv[i], "-no-optimize") == 0) {
+			optimize = false;
+		}
+		else if (strcmp(argv[i], "-simplify") == 0 && i + 1 < argc) {
+			simplifyTriangles = std::max(atoi(argv[++i]), 1);
+		}
+		else {
+			filenames.push_back(argv[i]);
+		}
+	}
+
+	if (filenames.empty()) {
+		std::cerr << "Usage: " << argv[0] << " [-no-centre] [-no-normalize] [-no-optimize] [-simplify triangles] file.obj ..." << std::endl;
+		return 1;
+	}
+
+	unsigned int flags = (autoCentre ? MESH_CACHE_AUTO_CENTRE : 0) | (autoNormalize ? MESH_CACHE_AUTO_NORMALIZE : 0) |
+		(optimize ? MESH_CACHE_OPTIMIZED : 0);
+	int failures = 0;
+
+	for (const std::string &filename : filenames) {
+		std::string cacheFilename = MeshCache::getCacheFilename(filename);
+
+		ObjMesh mesh;
+		mesh.setOptimizeEnabled(optimize);
+		auto parseStart = std::chrono::high_resolution_clock::now();
+		mesh.load(filename, autoCentre, autoNormalize);
+		double parseTime = millisecondsSince(parseStart);
+
+		if (simplifyTriangles > 0) {
+			if (mesh.getNumTriangles() == 0) {
+				std::cerr << "  failed to load " << filename << std::endl;
+				failures++;
+				continue;
+			}
+
+			std::string stem = filename.size() > 4 && filename.compare(filename.size() - 4, 4, ".obj") == 0 ? filename.substr(0, filename.size() - 4) : filename;
+			std::string simplifiedFilename = stem + "_" + std::to_string(simplifyTriangles) + ".obj";
+
+			auto simplifyStart = std::chrono::high_resolution_clock::now();
+			MeshSimplifier simplifier(mesh);
+			simplifier.simplify(simplifyTriangles);
+			double simplifyTime = millisecondsSince(simplifyStart);
+			simplifier.save(simplifiedFilename);
+
+			std::cout << "  wrote " << simplifiedFilename << ": "
+				<< mesh.getNumTriangles() << " to " << simplifier.getNumTriangles() << " triangles, "
+				<< mesh.getNumIndexedVertices() << " to " << simplifier.getNumVertices() << " vertices; "
+				<< "error " << simplifier.getError() << " (of a " << mesh.getDimensions().x << " wide mesh); "
+				<< "simplify " << simplifyTime << " ms" << std::endl;
+			continue;
+		}
+
+		if (mesh.getNumTriangles() == 0 || !MeshCache::write(cacheFilename, filename, flags, mesh)) {
+			std::cerr << "  failed to convert " << filename << std::endl;
+			failures++;
+			continue;
+		}
+
+		ObjMesh cached;
+		auto readStart = std::chrono::high_resolution_clock::now();
+		bool readBack = MeshCache::read(cacheFilename, filename, flags, cached);
+		double readTime = millisecondsSince(readStart);
+
+		if (!readBack || cached.getNumIndexedVertices() != mesh.getNumIndexedVertices() ||
+			memcmp(cached.getIndexedPositions(), mesh.getIndexedPositions(), mesh.getNumIndexedVertices() * sizeof(Vector3)) != 0 ||
+			memcmp(cached.getTriangleIndices(), mesh.getTriangleIndices(), mesh.getNumTriangles() * 3 * sizeof(unsigned int)) != 0) {
+			std::cerr << "  " << cacheFilename << " does not read back correctly" << std::endl;
+			failures++;
+			continue;
+		}
+
+		// the packed layout must round-trip within the precision of its formats:
+		// half an snorm10 step for normals, half a binary16 ulp for uvs
+		std::vector<Vertex> vertices;
+		std::vector<PackedVertex> packedVertices;
+		mesh.getVertices(vertices);
+		mesh.getPackedVertices(packedVertices);
+
+		float maxNormalError = 0.0f;
+		float maxTextureCoordError = 0.0f;
+		bool packingOk = true;
+		for (size_t i = 0; i < vertices.size(); i++) {
+			Vertex unpacked = unpackVertex(packedVertices[i]);
+			const float* normal = &vertices[i].normal.x;
+			const float* unpackedNormal = &unpacked.normal.x;
+			const float* textureCoord = &vertices[i].textureCoord.u;
+			const float* unpackedTextureCoord = &unpacked.textureCoord.u;
+
+			for (int c = 0; c < 3; c++) {
+				float error = std::fabs(normal[c] - unpackedNormal[c]);
+				maxNormalError = std::max(maxNormalError, error);
+				packingOk = packingOk && error <= 0.5f / 511.0f + 1e-6f;
+			}
+			for (int c = 0; c < 2; c++) {
+				float error = std::fabs(textureCoord[c] - unpackedTextureCoord[c]);
+				maxTextureCoordError = std::max(maxTextureCoordError, error);
+				packingOk = packingOk && error <= std::fabs(textureCoord[c]) / 2048.0f + 1e-7f;
+			}
+		}
+
+		if (!packingOk) {
+			std::cerr << "  " << filename << " does not survive vertex packing: normal error " << maxNormalError
+				<< ", uv error " << maxTextureCoordError << std::endl;
+			failures++;
+			continue;
+		}
+
+		std::cout << "  wrote " << cacheFilename << ": "
+			<< mesh.getNumIndexedVertices() << " vertices, " << mesh.getNumTriangles() << " triangles; "
+			<< "parse " << parseTime << " ms, cache read " << readTime << " ms; "
+			<< (optimize ? "vertex cache miss ratio " + std::to_string(mesh.getAcmrBefore()) + " -> " + std::to_string(mesh.getAcmrAfter()) + "; " : "")
+			<< "packed " << sizeof(PackedVertex) << "/" << sizeof(Vertex) << " bytes per vertex, max normal error "
+			<< maxNormalError << ", max uv error " << maxTextureCoordError << std::endl;
+	}
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+// Builds the DXT texture caches (see TextureCompressor.h) ahead of time, so the
+// first launch does not have to compress anything either.
+//
+//   ./texconv [-mip-filter box|kaiser] textures/stars.jpeg
+//
+// The default mip filter, kaiser, matches main.cpp.
+// For each image it reports the GPU memory saved against 8-bit RGBA with a full
+// mip chain, and how much faster reading the .dds is than decoding the source and
+// building the mip chain, which is what loading it uncompressed costs. The image is
+// also compressed with the scalar block encoder, to check the SIMD one matches it.
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "../apis/stb_image.h"
+
+#include "../MappedFile.h"
+#include "../MipmapGenerator.h"
+#include "../TextureCompressor.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <soil/src/image_DXT.h>
+}
+
+static double millisecondsSince(std::chrono::high_resolution_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+	int mipFilter = MIPMAP_FILTER_KAISER;
+	std::vector<std::string> filenames;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-mip-filter") == 0 && i + 1 < argc) {
+			mipFilter = MipmapGenerator::parseFilter(argv[++i]);
+		}
+		else {
+			filenames.push_back(argv[i]);
+		}
+	}
+
+	if (filenames.empty() || mipFilter < 0) {
+		std::cerr << "Usage: " << argv[0] << " [-mip-filter box|kaiser] image ..." << std::endl;
+		return 1;
+	}
+
+	int failures = 0;
+
+	for (const std::string &filename : filenames) {
+		std::string cacheFilename = TextureCompressor::getCacheFilename(filename);
+
+		// the uncompressed path: decode, then build the mip chain
+		auto decodeStart = std::chrono::high_resolution_clock::now();
+		int width, height, numComponents;
+		unsigned char* pixels = stbi_load(filename.c_str(), &width, &height, &numComponents, 4);
+		if (pixels == nullptr) {
+			std::cerr << "  failed to decode " << filename << ": " << stbi_failure_reason() << std::endl;
+			failures++;
+			continue;
+		}
+		double decodeTime = millisecondsSince(decodeStart);
+
+		auto mipStart = std::chrono::high_resolution_clock::now();
+		std::vector<MipLevel> mips;
+		MipmapGenerator::generate(pixels, width, height, mipFilter, true, mips);
+		double mipTime = millisecondsSince(mipStart);
+
+		CompressedImage image;
+		image.hash = MappedFile::hashFile(filename);
+		auto compressStart = std::chrono::high_resolution_clock::now();
+		TextureCompressor::compress(pixels, width, height, mipFilter, mips, image);
+		double compressTime = millisecondsSince(compressStart);
+
+		// the scalar block encoder, which the SIMD one must match byte for byte
+		CompressedImage scalar;
+		int simdEnabled = DXT_set_SIMD_enabled(0);
+		auto scalarStart = std::chrono::high_resolution_clock::now();
+		TextureCompressor::compress(pixels, width, height, mipFilter, mips, scalar);
+		double scalarTime = millisecondsSince(scalarStart);
+		DXT_set_SIMD_enabled(simdEnabled);
+		stbi_image_free(pixels);
+
+		bool simdMatches = scalar.levels.size() == image.levels.size();
+		for (size_t l = 0; simdMatches && l < image.levels.size(); l++) {
+			simdMatches = scalar.levels[l].data == image.levels[l].data;
+		}
+		if (!simdMatches) {
+			std::cerr << "  " << filename << ": the SIMD block encoder does not match the scalar one" << std::endl;
+			failures++;
+		}
+
+		if (!TextureCompressor::writeDds(cacheFilename, filename, image)) {
+			std::cerr << "  failed to write " << cacheFilename << std::endl;
+			failures++;
+			continue;
+		}
+
+		CompressedImage cached;
+		auto readStart = std::chrono::high_resolution_clock::now();
+		bool readBack = TextureCompressor::readDds(cacheFilename, filename, mipFilter, cached);
+		double readTime = millisecondsSince(readStart);
+
+		bool matches = readBack && cached.format == image.format && cached.levels.size() == image.levels.size() && cached.hash == image.hash;
+		for (size_t l = 0; matches && l < image.levels.size(); l++) {
+			matches = cached.levels[l].data == image.levels[l].data;
+		}
+		if (!matches) {
+			std::cerr << "  " << cacheFilename << " does not read back correctly" << std::endl;
+			failures++;
+			continue;
+		}
+
+		const char* simdNames[] = { "scalar", "SSE2", "AVX2" };
+		size_t uncompressedSize = image.getUncompressedSize();
+		// megapixels of the whole mip chain
+		double megapixels = uncompressedSize / 4 / 1e6;
+		size_t compressedSize = image.getSize();
+		std::cout << "  wrote " << cacheFilename << ": " << width << "x" << height << " "
+			<< (image.format == TEXTURE_FORMAT_DXT1 ? "DXT1" : "DXT5") << ", " << image.levels.size() << " levels; "
+			<< compressedSize / 1024 << " KB instead of " << uncompressedSize / 1024 << " KB RGBA8 ("
+			<< (uncompressedSize - compressedSize) / 1024 << " KB saved); "
+			<< "decode " << decodeTime << " ms, " << MipmapGenerator::getFilterName(mipFilter) << " mips " << mipTime << " ms, compress " << compressTime << " ms (" << simdNames[DXT_SIMD_level()] << ", "
+			<< megapixels / compressTime * 1000 << " MP/s; scalar " << megapixels / scalarTime * 1000 << " MP/s), cache read " << readTime << " ms ("
+			<< decodeTime + mipTime - readTime << " ms less per load)" << std::endl;
+	}
+
+	return failures == 0 ? 0 : 1;
+}